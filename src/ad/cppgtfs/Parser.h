@@ -6,27 +6,42 @@
 #define AD_CPPGTFS_PARSER_H_
 
 #include <stdint.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef LIBZIP_FOUND
 #include <zip.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
 #include <cstring>
 #include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <istream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "ad/util/CompressedCsvParser.h"
 #include "ad/util/CsvParser.h"
+#include "ad/util/IdMap.h"
 
 #ifdef LIBZIP_FOUND
 #include "ad/util/ZipCsvParser.h"
+#include "ad/util/ZipPrefetcher.h"
 #endif
 
 #include "gtfs/Feed.h"
@@ -55,11 +70,17 @@ using ad::cppgtfs::gtfs::StopTime;
 using ad::cppgtfs::gtfs::Time;
 using ad::cppgtfs::gtfs::Transfer;
 using ad::cppgtfs::gtfs::TripB;
+using ad::util::CompressedCsvParser;
+using ad::util::CsvChunk;
+using ad::util::CsvField;
 using ad::util::CsvParser;
 using ad::util::CsvParserException;
+using ad::util::IdMap;
+using ad::util::IdSet;
 
 #ifdef LIBZIP_FOUND
 using ad::util::ZipCsvParser;
+using ad::util::ZipPrefetcher;
 #endif
 
 using std::string;
@@ -103,6 +124,163 @@ class ParserException : public std::exception {
   std::string _file_name;
 };
 
+// A warning raised while parsing in non-strict mode. Warnings are stored
+// in this compact form and only formatted into messages on delivery.
+struct ParserWarning {
+  enum CODE : uint8_t { INT_OUT_OF_RANGE = 0, INVALID_HEX_COLOR = 1 };
+
+  CODE code;
+  // index into the list of fields warnings were raised for
+  uint32_t fld;
+  int32_t line;
+  // the offset of the offending value for INVALID_HEX_COLOR in the values
+  // of the warnings
+  uint32_t val;
+  // the expected range for INT_OUT_OF_RANGE
+  int64_t minv, maxv;
+};
+
+// A field (in a specific file) warnings were raised for
+struct ParserWarningField {
+  std::string fileName;
+  std::string fieldName;
+  size_t count;
+};
+
+// The warnings raised while parsing, and the fields they were raised for
+struct ParserWarnings {
+  std::vector<ParserWarning> warnings;
+  std::vector<ParserWarningField> fields;
+
+  // the values the warnings refer to, each terminated by a 0
+  std::string vals;
+
+  // per-field indices into fields for the file warnings were last raised for
+  std::string path;
+  std::vector<uint32_t> fieldIdx;
+};
+
+// The bounding box of the coordinates of a single table
+struct ParserBox {
+  double minLat = std::numeric_limits<double>::max();
+  double minLng = std::numeric_limits<double>::max();
+  double maxLat = std::numeric_limits<double>::lowest();
+  double maxLng = std::numeric_limits<double>::lowest();
+
+  void update(double lat, double lng) {
+    if (lat > maxLat) maxLat = lat;
+    if (lng > maxLng) maxLng = lng;
+    if (lat < minLat) minLat = lat;
+    if (lng < minLng) minLng = lng;
+  }
+};
+
+// Restricts what parse() reads, to save memory if only a part of a feed is
+// needed. Entities referencing dropped entities are dropped as well, e.g. the
+// trips of dropped routes and their stop times, without being allocated.
+struct ParseOptions {
+  // the tables not to read, by file name (e.g. "shapes.txt"). agency.txt,
+  // stops.txt, routes.txt, trips.txt, stop_times.txt, calendar.txt and
+  // calendar_dates.txt cannot be skipped.
+  std::set<std::string> skipTables;
+
+  // if not empty, only these agencies and their routes are kept
+  std::set<std::string> agencies;
+
+  // if not empty, only routes of these types are kept
+  std::set<gtfs::flat::Route::TYPE> routeTypes;
+
+  // if set, only stops inside the box are kept. Stops without coordinates
+  // are kept if their parent station is. Stop times at other stops are
+  // dropped, their trips are kept.
+  bool useBox = false;
+  double minLat = 0, minLng = 0, maxLat = 0, maxLng = 0;
+
+  // if set, only trips whose service is active on at least one day in
+  // [from, to] are kept
+  bool useDates = false;
+  gtfs::ServiceDate from, to;
+};
+
+// The ids of the entities parse() dropped because of its ParseOptions
+struct ParserDropped {
+  IdSet agencies, stops, zones, routes, trips, fares;
+
+  // if all agencies were dropped, routes without an agency are dropped too
+  bool allAgencies = false;
+};
+
+// How parse() read a single table. All times are in milliseconds.
+struct ParserTableStats {
+  std::string file;
+
+  // the size of the table in the ZIP or compressed file, 0 if it was read
+  // from a plain file, and its uncompressed size
+  size_t compressedBytes = 0;
+  size_t bytes = 0;
+  size_t rows = 0;
+
+  // the wall time spent opening (and inflating) the table, reading its rows
+  // into entities, and adding rows read in chunks to the feed. For tables not
+  // read in chunks, adding the rows is part of readMs.
+  double openMs = 0;
+  double readMs = 0;
+  double insertMs = 0;
+  double wallMs = 0;
+
+  // the CPU time of all threads reading the table
+  double cpuMs = 0;
+
+  // the growth of the resident memory while the table was read. Tables read
+  // at the same time share it.
+  int64_t rssGrowth = 0;
+
+  double rowsPerSec() const { return wallMs > 0 ? rows / wallMs * 1000 : 0; }
+};
+
+// How parse() read a feed
+struct ParseStats {
+  // in the order parse() reads them sequentially
+  std::vector<ParserTableStats> tables;
+
+  double wallMs = 0;
+  double cpuMs = 0;
+
+  // the peak resident memory of the process after parsing
+  size_t peakRss = 0;
+};
+
+// Receives the rows of a feed streamed with Parser::stream(), table by table.
+// Rows are only valid during the call.
+class FeedVisitor {
+ public:
+  virtual ~FeedVisitor() {}
+
+  // whether the table file (e.g. "shapes.txt") should be read, by default
+  // all tables are read
+  virtual bool wants(const std::string& file) const {
+    (void)file;
+    return true;
+  }
+
+  virtual void agency(const gtfs::flat::Agency&) {}
+  virtual void level(const gtfs::flat::Level&) {}
+  virtual void stop(const gtfs::flat::Stop&) {}
+  virtual void route(const gtfs::flat::Route&) {}
+  virtual void calendar(const gtfs::flat::Calendar&) {}
+  virtual void calendarDate(const gtfs::flat::CalendarDate&) {}
+  virtual void shapePoint(const gtfs::flat::ShapePoint&) {}
+  virtual void trip(const gtfs::flat::Trip&) {}
+  virtual void stopTime(const gtfs::flat::StopTime&) {}
+  virtual void frequency(const gtfs::flat::Frequency&) {}
+  virtual void transfer(const gtfs::flat::Transfer&) {}
+  virtual void attribution(const gtfs::flat::Attribution&) {}
+  virtual void fare(const gtfs::flat::Fare&) {}
+  virtual void fareRule(const gtfs::flat::FareRule&) {}
+  virtual void pathway(const gtfs::flat::Pathway&) {}
+  virtual void translation(const gtfs::flat::Translation&) {}
+};
+
 class Parser {
  public:
   Parser(const std::string& path) : Parser(path, false, false, 0) {}
@@ -115,7 +293,8 @@ class Parser {
       : _path(path),
         _strict(strict),
         _parseAdditionalFields(parseAdditionalFields),
-        _warnCb(warnCb)
+        _warnCb(warnCb),
+        _numThreads(std::thread::hardware_concurrency())
 #ifdef LIBZIP_FOUND
         ,
         _za(0)
@@ -140,6 +319,8 @@ class Parser {
         auto err = zip_error_strerror(&zipErrT);
         throw ParserException(err, "", -1, path);
       }
+
+      _stored = ZipCsvParser::locateStored(_za, path);
     }
 #else
       throw ParserException(
@@ -149,7 +330,71 @@ class Parser {
 #endif
   }
 
+  // Parses a ZIP file held in memory, without a round trip through the
+  // file system. The data must stay valid while the parser is used. name
+  // is only used in messages.
+  Parser(const char* zipData, size_t size, const std::string& name,
+         bool strict, bool parseAdditionalFields, void (*warnCb)(std::string))
+      : _path(name),
+        _strict(strict),
+        _parseAdditionalFields(parseAdditionalFields),
+        _warnCb(warnCb),
+        _numThreads(std::thread::hardware_concurrency())
+#ifdef LIBZIP_FOUND
+        ,
+        _za(0),
+        _zipData(zipData),
+        _zipSize(size)
+#endif
+  {
+#ifdef LIBZIP_FOUND
+    zip_error_t zipErr;
+    zip_error_init(&zipErr);
+
+    zip_source_t* src = zip_source_buffer_create(zipData, size, 0, &zipErr);
+    if (src) {
+      _za = zip_open_from_source(src, ZIP_RDONLY, &zipErr);
+      if (_za == 0) zip_source_free(src);
+    }
+
+    if (_za == 0) {
+      std::string err = zip_error_strerror(&zipErr);
+      zip_error_fini(&zipErr);
+      throw ParserException(err, "", -1, name);
+    }
+
+    zip_error_fini(&zipErr);
+#else
+    (void)zipData;
+    (void)size;
+    throw ParserException(
+        "Cannot read from ZIP file, was compiled without libzip", "", -1,
+        name);
+#endif
+  }
+
+  // Parses the tables held in memory, given as a map of file names (e.g.
+  // "stops.txt") to their contents, which is moved into the parser if
+  // possible. name is only used in messages.
+  Parser(std::unordered_map<std::string, std::string> tables,
+         const std::string& name, bool strict, bool parseAdditionalFields,
+         void (*warnCb)(std::string))
+      : _path(name),
+        _strict(strict),
+        _parseAdditionalFields(parseAdditionalFields),
+        _warnCb(warnCb),
+        _numThreads(std::thread::hardware_concurrency()),
+        _tables(new std::unordered_map<std::string, std::string>(
+            std::move(tables)))
+#ifdef LIBZIP_FOUND
+        ,
+        _za(0)
+#endif
+  {
+  }
+
   ~Parser() {
+    flushWarnings();
 #ifdef LIBZIP_FOUND
     if (_za) zip_close(_za);
 #endif
@@ -159,10 +404,66 @@ class Parser {
   FEEDTPL
   bool parse(gtfs::FEEDB* targetFeed) const;
 
+  // Streams the rows of the feed to v, without building a feed. The tables
+  // are read one after another, in the order parse() reads them. Files are
+  // read from a read-only mapping whose pages are released once read, ZIP
+  // members are inflated while they are read, and at most two chunks of
+  // STREAM_CHUNK_SIZE bytes per thread are buffered as rows. Memory thus
+  // does not grow with the size of the tables, only with the ids kept for
+  // checkRefs. feed_info.txt is not streamed. If checkRefs is true,
+  // references are checked against the ids of the tables read before, and
+  // an exception is thrown for unknown ids as in parse(). References to
+  // tables v does not want are not checked.
+  inline bool stream(FeedVisitor* v, bool checkRefs) const;
+
+  // formats all pending warnings and passes them to the warning callback
+  inline void flushWarnings() const;
+
+  // limits the number of warnings delivered per field and file, further
+  // warnings are only counted
+  void setMaxWarningsPerField(size_t n) { _maxWarnsPerField = n; }
+
+  // restricts what parse() reads, see ParseOptions
+  inline void setParseOptions(const ParseOptions& opts);
+
+  // returns how the last call of parse() read the feed
+  const ParseStats& getStats() const { return _stats; }
+
+  // sets a callback parse() passes the stats of each table to once it has
+  // been read, in the order the tables are finished. The callback is not
+  // called concurrently.
+  void setStatsCallback(
+      const std::function<void(const ParserTableStats&)>& statsCb) {
+    _statsCb = statsCb;
+  }
+
+  // sets the number of threads large tables (stop_times.txt, shapes.txt)
+  // are parsed with, and ZIP members are inflated with. 0 uses the number
+  // of hardware threads.
+  void setNumThreads(size_t n) {
+    _numThreads = n ? n : std::thread::hardware_concurrency();
+  }
+
+  // Lets parse() inflate ZIP members ahead of time on background threads,
+  // holding at most maxBytes of inflated data at once. Members larger than
+  // maxBytes are inflated while they are read. 0 (the default) disables
+  // prefetching, all members are then inflated while they are read.
+  void setZipPrefetch(size_t maxBytes) {
+#ifdef LIBZIP_FOUND
+    _prefetchBytes = maxBytes;
+#else
+    (void)maxBytes;
+#endif
+  }
+
   inline std::string getString(const CsvParser& csv, size_t field) const;
   inline std::string getString(const CsvParser& csv, size_t field,
                                const std::string& def) const;
 
+  // same as getString(csv, field), but assigns to ret, to reuse its memory
+  inline void getString(const CsvParser& csv, size_t field,
+                        std::string* ret) const;
+
   inline double getDouble(const CsvParser& csv, size_t field) const;
   inline double getDouble(const CsvParser& csv, size_t fld, double def) const;
 
@@ -303,17 +604,222 @@ class Parser {
 
   inline std::unique_ptr<CsvParser> getCsvParser(const std::string& file) const;
 
+  // Same as above. If whole is false, compressed ZIP members are always
+  // inflated while they are parsed, instead of as a whole.
+  inline std::unique_ptr<CsvParser> getCsvParser(const std::string& file,
+                                                 bool whole) const;
+
  private:
+  // opens the table file for getCsvParser()
+  inline std::unique_ptr<CsvParser> openCsvParser(const std::string& file,
+                                                  bool whole) const;
+
   std::string _path;
   bool _strict;
   bool _parseAdditionalFields;
   void (*_warnCb)(std::string);
+  size_t _numThreads;
+
+  // the tables, if parsed from memory
+  std::unique_ptr<std::unordered_map<std::string, std::string>> _tables;
+
+  size_t _maxWarnsPerField = 100;
+
+  ParseOptions _opts;
+  mutable ParserDropped _dropped;
+  mutable ParserWarnings _warns;
+
+  // whether warnings are collected until the end of parse() or stream(),
+  // instead of delivered at once
+  mutable bool _deferWarnings = false;
+
+  mutable ParseStats _stats;
+  std::function<void(const ParserTableStats&)> _statsCb;
+  mutable std::mutex _statsMutex;
+
+  // guards the bounding box of the feed, which stops.txt and shapes.txt
+  // may update at the same time
+  mutable std::mutex _boxMutex;
+
+  // The threads in use of the _numThreads parse() may keep busy: the threads
+  // of runTasks() while they run a task, the workers of parseChunked() and
+  // the threads decompressing tables. A thread merging the chunks of
+  // parseChunked() is counted as the thread which called it.
+  mutable size_t _threadsInUse = 0;
+  mutable std::mutex _threadsMutex;
+  mutable std::condition_variable _threadsCv;
 
 #ifdef LIBZIP_FOUND
   zip* _za;
+
+  // the ZIP file, if parsed from memory
+  const char* _zipData = 0;
+  size_t _zipSize = 0;
+
+  // the members stored without compression, which are tokenized directly
+  // from a mapping of the archive, by their index. Empty if the archive is
+  // held in memory.
+  std::unordered_map<zip_uint64_t, ZipCsvParser::StoredMember> _stored;
+
+  // inflates the members of _za in the background during parse(), if
+  // enabled with setZipPrefetch()
+  mutable std::unique_ptr<ZipPrefetcher> _prefetch;
+  size_t _prefetchBytes = 0;
+
+  // If set, the handle of the archive the tables read on the current thread
+  // are read through, 0 until it is opened. Set while runTasks() runs tasks
+  // on several threads, as a handle must not be used by several threads at
+  // once.
+  inline static zip**& taskArchive();
+
+  // the handle of the archive tables are read through on the current thread
+  inline zip* archive() const;
+
+  // where the data of member file of za is in the archive, if it is stored
+  // without compression, 0 otherwise
+  inline const ZipCsvParser::StoredMember* storedMember(
+      zip* za, const std::string& file) const;
 #endif
 
+  // Records a warning for field at line of csv. minv and maxv are the
+  // expected range for INT_OUT_OF_RANGE, val is the offending value for
+  // INVALID_HEX_COLOR. Outside of parse() and stream(), the warning is
+  // delivered at once.
+  inline void warn(const CsvParser& csv, size_t field, int32_t line,
+                   ParserWarning::CODE code, int64_t minv, int64_t maxv,
+                   const char* val) const;
+  inline std::string formatWarning(const ParserWarning& w) const;
+
+  // if set, warnings raised on the current thread are collected here
+  inline static ParserWarnings*& chunkWarnings();
+
+  // if set, warnings raised on the current thread outside of chunks are
+  // recorded here instead of in _warns
+  inline static ParserWarnings*& taskWarnings();
+
+  // if set, the stats of the table read on the current thread
+  inline static ParserTableStats*& tableStats();
+
+  // If set, the number of threads the task running on the current thread
+  // took in addition to its own, which are given back when it ends. Set
+  // while runTasks() runs tasks on several threads.
+  inline static size_t*& taskThreads();
+
+  // Takes up to n of the threads left of _numThreads, waiting until there
+  // is at least one if wait is set. Returns the number of threads taken.
+  inline size_t takeThreads(size_t n, bool wait) const;
+
+  // gives back n threads taken with takeThreads()
+  inline void giveThreads(size_t n) const;
+
+  // whether a table read from a compressed source is decompressed on a
+  // thread of its own
+  inline bool readThreaded() const;
+
+  // runs task, which reads the table of stats, and records its stats
+  inline void measure(ParserTableStats* stats,
+                      const std::function<void()>& task) const;
+
+  // adds the lines and bytes read by csv to the stats of the current table
+  inline static void countTable(const CsvParser& csv);
+
+  // s as a text field of type TextT, stored in pool for a PoolString
+  template <typename TextT>
+  inline static TextT text(gtfs::StringPool* pool, const std::string& s);
+
+  // the resident memory and peak resident memory of the process in bytes,
+  // and the CPU time of the calling thread and of the process in ms
+  inline static size_t residentMemory();
+  inline static size_t peakResidentMemory();
+  inline static double threadCpuMs();
+  inline static double processCpuMs();
+
+  // milliseconds since an arbitrary point in time
+  inline static double wallMs();
+
+  // appends warnings recorded for a task to _warns
+  inline void mergeWarnings(const ParserWarnings& w) const;
+
+  // Runs tasks on up to _numThreads threads, each after the tasks it depends
+  // on. The tasks share the threads with the threads they start. Warnings
+  // are recorded, and the first error is rethrown, as if the tasks had run
+  // one after another in the given order.
+  inline void runTasks(const std::vector<std::function<void()>>& tasks,
+                       const std::vector<std::vector<size_t>>& deps) const;
+
+  // adds box to the bounding box of targetFeed
+  FEEDTPL
+  void addBox(gtfs::FEEDB* targetFeed, const ParserBox& box) const;
+
+  // whether table file is read, or skipped because of the ParseOptions
+  inline bool reads(const std::string& file) const;
+
+  // whether a stop at lat, lng is kept because of the ParseOptions
+  inline bool keepStop(double lat, double lng) const;
+
+  // Streams the rows of table file to cb, which also gets the line and the
+  // readable path of each row. Throws if the table is required but does not
+  // exist.
+  template <typename T, typename FLDS>
+  void streamTable(const std::string& file, bool required,
+                   FLDS (*getFlds)(CsvParser*),
+                   bool (Parser::*next)(CsvParser*, T*, const FLDS&) const,
+                   const std::function<void(const T&, int32_t,
+                                            const std::string&)>& cb) const;
+
+  // Throws if ids is given and id is not in it. what is the entity the ids
+  // belong to, file the table defining them.
+  inline static void checkRef(const IdSet* ids, const std::string& id,
+                              const char* what, const char* file,
+                              const char* field, int32_t line,
+                              const std::string& path);
+
+  // adds a warning w collected for a chunk of csv in chunk
+  inline void addChunkWarning(const CsvParser& csv,
+                              const ParserWarnings& chunk,
+                              const ParserWarning& w) const;
+
+  // the approximate size of the chunks large tables are split into for
+  // parallel parsing
+  static const size_t CHUNK_SIZE = 1 << 22;
+
+  // the size of the chunks for stream(), smaller to bound the rows buffered
+  // until they are visited
+  static const size_t STREAM_CHUNK_SIZE = 1 << 20;
+
+  // Reads all remaining rows of csvp with next(), and passes them together
+  // with their line number to add(), in file order. If possible, the rows
+  // are read from chunks of about chunkSize bytes in parallel, on the
+  // threads left of _numThreads. At most two chunks per thread are read
+  // ahead of add().
+  template <typename T, typename FLDS>
+  void parseChunked(CsvParser* csvp, const FLDS& flds,
+                    bool (Parser::*next)(CsvParser*, T*, const FLDS&) const,
+                    const std::function<void(const T&, int32_t)>& add,
+                    size_t chunkSize = CHUNK_SIZE) const;
+  inline static bool decodeHexColor(const char* val, uint32_t* ret);
+
+  // Returns the line of the first of rows (sequence numbers and their lines)
+  // that repeats a sequence number of the same trip or shape, or -1. seqs
+  // are all sequence numbers of the trip or shape. The ones not in rows
+  // are unique and were read before rows.
+  template <typename S>
+  static int32_t firstSeqCollision(std::vector<std::pair<S, int32_t>>* rows,
+                                   std::vector<S>* seqs);
+
   static uint32_t atoi(const char** p);
+  static bool isDigit(char c);
+
+  enum TIME_STATUS : uint8_t {
+    TIME_OK = 0,
+    TIME_HOUR_RANGE = 1,
+    TIME_INVALID_SEP = 2,
+    TIME_MINUTE_RANGE = 3,
+    TIME_SECOND_RANGE = 4
+  };
+
+  // decodes a time in HH:MM:SS (or H:MM:SS) format into t, without throwing
+  inline static TIME_STATUS decodeTime(const char* val, Time* t);
 
   FEEDTPL
   void parseAgencies(gtfs::FEEDB* targetFeed, CsvParser* csvp) const;
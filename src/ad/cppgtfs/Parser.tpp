@@ -8,28 +8,410 @@ FEEDTPL bool Parser::parse(gtfs::FEEDB* targetFeed) const {
   std::string curFile;
 
   targetFeed->setPath(_path);
+  _dropped = ParserDropped();
 
-  parseFeedInfo(targetFeed);
-  parseAgencies(targetFeed);
-  parseLevels(targetFeed);
-  parseStops(targetFeed);
-  parseRoutes(targetFeed);
-  parseCalendar(targetFeed);
-  parseCalendarDates(targetFeed);
-  parseShapes(targetFeed);
-  parseTrips(targetFeed);
-  parseStopTimes(targetFeed);
-  parseFrequencies(targetFeed);
-  parseTransfers(targetFeed);
-  parseAttributions(targetFeed);
-  parseFareAttributes(targetFeed);
-  parseFareRules(targetFeed);
-  parsePathways(targetFeed);
-  parseTranslations(targetFeed);
+  // in the order they are parsed below
+  const std::vector<std::string> files = {
+      "feed_info.txt", "agency.txt", "levels.txt", "stops.txt", "routes.txt",
+      "calendar.txt", "calendar_dates.txt", "shapes.txt", "trips.txt",
+      "stop_times.txt", "frequencies.txt", "transfers.txt",
+      "attributions.txt", "fare_attributes.txt", "fare_rules.txt",
+      "pathways.txt", "translations.txt"};
+
+  _stats = ParseStats();
+  _stats.tables.resize(files.size());
+  double wallStart = wallMs();
+  double cpuStart = processCpuMs();
+
+#ifdef LIBZIP_FOUND
+  if (_za && _prefetchBytes && _numThreads > 1) {
+    // members stored without compression are read directly from the
+    // archive instead
+    std::vector<std::string> members;
+    for (const auto& m : files) {
+      if (reads(m) && !storedMember(_za, m)) members.push_back(m);
+    }
+
+    if (_zipData)
+      _prefetch.reset(new ZipPrefetcher(_zipData, _zipSize, members,
+                                        _numThreads, _prefetchBytes));
+    else
+      _prefetch.reset(
+          new ZipPrefetcher(_path, members, _numThreads, _prefetchBytes));
+  }
+#endif
+
+  // the tables in the order they are parsed sequentially, and the tables
+  // each of them needs. frequencies.txt and stop_times.txt both modify
+  // trips, so they are parsed one after another.
+  std::vector<std::function<void()>> tables = {
+      [&] { parseFeedInfo(targetFeed); },       // 0
+      [&] { parseAgencies(targetFeed); },       // 1
+      [&] { parseLevels(targetFeed); },         // 2
+      [&] { parseStops(targetFeed); },          // 3
+      [&] { parseRoutes(targetFeed); },         // 4
+      [&] { parseCalendar(targetFeed); },       // 5
+      [&] { parseCalendarDates(targetFeed); },  // 6
+      [&] { parseShapes(targetFeed); },         // 7
+      [&] { parseTrips(targetFeed); },          // 8
+      [&] { parseStopTimes(targetFeed); },      // 9
+      [&] { parseFrequencies(targetFeed); },    // 10
+      [&] { parseTransfers(targetFeed); },      // 11
+      [&] { parseAttributions(targetFeed); },   // 12
+      [&] { parseFareAttributes(targetFeed); }, // 13
+      [&] { parseFareRules(targetFeed); },      // 14
+      [&] { parsePathways(targetFeed); },       // 15
+      [&] { parseTranslations(targetFeed); }};  // 16
+
+  std::vector<std::vector<size_t>> deps = {
+      {},         // feed_info.txt
+      {},         // agency.txt
+      {},         // levels.txt
+      {2},        // stops.txt
+      {1},        // routes.txt
+      {},         // calendar.txt
+      {5},        // calendar_dates.txt
+      {},         // shapes.txt
+      {4, 6, 7},  // trips.txt
+      {3, 8},     // stop_times.txt
+      {8, 9},     // frequencies.txt
+      {3, 4, 8},  // transfers.txt
+      {1, 4, 8},  // attributions.txt
+      {1},        // fare_attributes.txt
+      {3, 4, 13}, // fare_rules.txt
+      {3},        // pathways.txt
+      {}};        // translations.txt
+
+  for (size_t i = 0; i < tables.size(); i++) {
+    _stats.tables[i].file = files[i];
+    auto table = tables[i];
+    tables[i] = [this, i, table] { measure(&_stats.tables[i], table); };
+  }
+
+  _deferWarnings = true;
+
+  try {
+    runTasks(tables, deps);
+  } catch (...) {
+    // deliver the warnings raised before the error
+    _deferWarnings = false;
+    flushWarnings();
+#ifdef LIBZIP_FOUND
+    _prefetch.reset();
+#endif
+    throw;
+  }
+
+  _deferWarnings = false;
+  flushWarnings();
+#ifdef LIBZIP_FOUND
+  _prefetch.reset();
+#endif
+
+  _stats.wallMs = wallMs() - wallStart;
+  _stats.cpuMs = processCpuMs() - cpuStart;
+  _stats.peakRss = peakResidentMemory();
 
   return true;
 }
 
+// ____________________________________________________________________________
+bool Parser::stream(FeedVisitor* v, bool checkRefs) const {
+  // the ids of the tables read so far, if references are checked
+  IdSet agencies, levels, stops, zones, routes, services, shapes, trips, fares;
+
+  auto ids = [&](IdSet* s, bool read) -> IdSet* {
+    return checkRefs && read ? s : 0;
+  };
+
+  IdSet* agencyIds = ids(&agencies, v->wants("agency.txt"));
+  IdSet* levelIds = ids(&levels, v->wants("levels.txt"));
+  IdSet* stopIds = ids(&stops, v->wants("stops.txt"));
+  IdSet* zoneIds = ids(&zones, v->wants("stops.txt"));
+  IdSet* routeIds = ids(&routes, v->wants("routes.txt"));
+  IdSet* serviceIds = ids(&services, v->wants("calendar.txt") &&
+                                         v->wants("calendar_dates.txt"));
+  IdSet* shapeIds = ids(&shapes, v->wants("shapes.txt"));
+  IdSet* tripIds = ids(&trips, v->wants("trips.txt"));
+  IdSet* fareIds = ids(&fares, v->wants("fare_attributes.txt"));
+
+  auto optRef = [](const IdSet* ids, const std::string& id, const char* what,
+                   const char* file, const char* field, int32_t line,
+                   const std::string& path) {
+    if (!id.empty()) checkRef(ids, id, what, file, field, line, path);
+  };
+
+  _deferWarnings = true;
+
+  try {
+    if (v->wants("agency.txt")) {
+      streamTable<gtfs::flat::Agency>(
+          "agency.txt", true, &Parser::getAgencyFlds, &Parser::nextAgency,
+          [&](const gtfs::flat::Agency& a, int32_t, const std::string&) {
+            if (agencyIds) agencyIds->add(a.id);
+            v->agency(a);
+          });
+    }
+
+    if (v->wants("levels.txt")) {
+      streamTable<gtfs::flat::Level>(
+          "levels.txt", false, &Parser::getLevelFlds, &Parser::nextLevel,
+          [&](const gtfs::flat::Level& l, int32_t, const std::string&) {
+            if (levelIds) levelIds->add(l.id);
+            v->level(l);
+          });
+    }
+
+    if (v->wants("stops.txt")) {
+      // parent stations may be defined after their children
+      std::vector<std::pair<std::string, int32_t>> parents;
+      std::string path;
+
+      streamTable<gtfs::flat::Stop>(
+          "stops.txt", true, &Parser::getStopFlds, &Parser::nextStop,
+          [&](const gtfs::flat::Stop& s, int32_t line,
+              const std::string& p) {
+            optRef(levelIds, s.level_id, "level", "levels.txt", "level_id",
+                   line, p);
+            if (stopIds) {
+              stopIds->add(s.id);
+              if (!s.parent_station.empty() && !stopIds->has(s.parent_station))
+                parents.push_back({s.parent_station, line});
+            }
+            if (zoneIds && !s.zone_id.empty()) zoneIds->add(s.zone_id);
+            path = p;
+            v->stop(s);
+          });
+
+      for (const auto& p : parents) {
+        checkRef(stopIds, p.first, "stop", "stops.txt", "parent_station",
+                 p.second, path);
+      }
+    }
+
+    if (v->wants("routes.txt")) {
+      streamTable<gtfs::flat::Route>(
+          "routes.txt", true, &Parser::getRouteFlds, &Parser::nextRoute,
+          [&](const gtfs::flat::Route& r, int32_t line, const std::string& p) {
+            optRef(agencyIds, r.agency, "agency", "agency.txt", "agency_id",
+                   line, p);
+            if (routeIds) routeIds->add(r.id);
+            v->route(r);
+          });
+    }
+
+    if (v->wants("calendar.txt")) {
+      streamTable<gtfs::flat::Calendar>(
+          "calendar.txt", false, &Parser::getCalendarFlds,
+          &Parser::nextCalendar,
+          [&](const gtfs::flat::Calendar& c, int32_t, const std::string&) {
+            if (serviceIds) serviceIds->add(c.id);
+            v->calendar(c);
+          });
+    }
+
+    if (v->wants("calendar_dates.txt")) {
+      streamTable<gtfs::flat::CalendarDate>(
+          "calendar_dates.txt", false, &Parser::getCalendarDateFlds,
+          &Parser::nextCalendarDate,
+          [&](const gtfs::flat::CalendarDate& c, int32_t,
+              const std::string&) {
+            if (serviceIds) serviceIds->add(c.id);
+            v->calendarDate(c);
+          });
+    }
+
+    if (v->wants("shapes.txt")) {
+      streamTable<gtfs::flat::ShapePoint>(
+          "shapes.txt", false, &Parser::getShapeFlds, &Parser::nextShapePoint,
+          [&](const gtfs::flat::ShapePoint& s, int32_t, const std::string&) {
+            if (shapeIds) shapeIds->add(s.id);
+            v->shapePoint(s);
+          });
+    }
+
+    if (v->wants("trips.txt")) {
+      streamTable<gtfs::flat::Trip>(
+          "trips.txt", true, &Parser::getTripFlds, &Parser::nextTrip,
+          [&](const gtfs::flat::Trip& t, int32_t line, const std::string& p) {
+            checkRef(routeIds, t.route, "route", "routes.txt", "route_id",
+                     line, p);
+            checkRef(serviceIds, t.service, "service",
+                     "calendar.txt or calendar_dates.txt", "service_id", line,
+                     p);
+            optRef(shapeIds, t.shape, "shape", "shapes.txt", "shape_id", line,
+                   p);
+            if (tripIds) tripIds->add(t.id);
+            v->trip(t);
+          });
+    }
+
+    if (v->wants("stop_times.txt")) {
+      streamTable<gtfs::flat::StopTime>(
+          "stop_times.txt", true, &Parser::getStopTimeFlds,
+          &Parser::nextStopTime,
+          [&](const gtfs::flat::StopTime& st, int32_t line,
+              const std::string& p) {
+            checkRef(stopIds, st.s, "stop", "stops.txt", "stop_id", line, p);
+            checkRef(tripIds, st.trip, "trip", "trips.txt", "trip_id", line,
+                     p);
+            v->stopTime(st);
+          });
+    }
+
+    if (v->wants("frequencies.txt")) {
+      streamTable<gtfs::flat::Frequency>(
+          "frequencies.txt", false, &Parser::getFrequencyFlds,
+          &Parser::nextFrequency,
+          [&](const gtfs::flat::Frequency& f, int32_t line,
+              const std::string& p) {
+            checkRef(tripIds, f.tripId, "trip", "trips.txt", "trip_id", line,
+                     p);
+            v->frequency(f);
+          });
+    }
+
+    if (v->wants("transfers.txt")) {
+      streamTable<gtfs::flat::Transfer>(
+          "transfers.txt", false, &Parser::getTransfersFlds,
+          &Parser::nextTransfer,
+          [&](const gtfs::flat::Transfer& t, int32_t line,
+              const std::string& p) {
+            optRef(stopIds, t.fromStop, "stop", "stops.txt", "from_stop_id",
+                   line, p);
+            optRef(stopIds, t.toStop, "stop", "stops.txt", "to_stop_id", line,
+                   p);
+            optRef(routeIds, t.fromRoute, "route", "routes.txt",
+                   "from_route_id", line, p);
+            optRef(routeIds, t.toRoute, "route", "routes.txt", "to_route_id",
+                   line, p);
+            optRef(tripIds, t.fromTrip, "trip", "trips.txt", "from_trip_id",
+                   line, p);
+            optRef(tripIds, t.toTrip, "trip", "trips.txt", "to_trip_id", line,
+                   p);
+            v->transfer(t);
+          });
+    }
+
+    if (v->wants("attributions.txt")) {
+      streamTable<gtfs::flat::Attribution>(
+          "attributions.txt", false, &Parser::getAttributionsFlds,
+          &Parser::nextAttribution,
+          [&](const gtfs::flat::Attribution& a, int32_t line,
+              const std::string& p) {
+            optRef(agencyIds, a.agencyId, "agency", "agency.txt", "agency_id",
+                   line, p);
+            optRef(routeIds, a.routeId, "route", "routes.txt", "route_id",
+                   line, p);
+            optRef(tripIds, a.tripId, "trip", "trips.txt", "trip_id", line, p);
+            v->attribution(a);
+          });
+    }
+
+    if (v->wants("fare_attributes.txt")) {
+      streamTable<gtfs::flat::Fare>(
+          "fare_attributes.txt", false, &Parser::getFareFlds,
+          &Parser::nextFare,
+          [&](const gtfs::flat::Fare& f, int32_t line, const std::string& p) {
+            optRef(agencyIds, f.agency, "agency", "agency.txt", "agency_id",
+                   line, p);
+            if (fareIds) fareIds->add(f.id);
+            v->fare(f);
+          });
+    }
+
+    if (v->wants("fare_rules.txt")) {
+      streamTable<gtfs::flat::FareRule>(
+          "fare_rules.txt", false, &Parser::getFareRuleFlds,
+          &Parser::nextFareRule,
+          [&](const gtfs::flat::FareRule& r, int32_t line,
+              const std::string& p) {
+            checkRef(fareIds, r.fare, "fare", "fare_attributes.txt",
+                     "fare_id", line, p);
+            optRef(routeIds, r.route, "route", "routes.txt", "route_id", line,
+                   p);
+            optRef(zoneIds, r.originZone, "zone", "stops.txt", "origin_id",
+                   line, p);
+            optRef(zoneIds, r.destZone, "zone", "stops.txt", "destination_id",
+                   line, p);
+            optRef(zoneIds, r.containsZone, "zone", "stops.txt",
+                   "contains_id", line, p);
+            v->fareRule(r);
+          });
+    }
+
+    if (v->wants("pathways.txt")) {
+      streamTable<gtfs::flat::Pathway>(
+          "pathways.txt", false, &Parser::getPathwayFlds,
+          &Parser::nextPathway,
+          [&](const gtfs::flat::Pathway& w, int32_t line,
+              const std::string& p) {
+            checkRef(stopIds, w.from_stop_id, "stop", "stops.txt",
+                     "from_stop_id", line, p);
+            checkRef(stopIds, w.to_stop_id, "stop", "stops.txt",
+                     "to_stop_id", line, p);
+            v->pathway(w);
+          });
+    }
+
+    if (v->wants("translations.txt")) {
+      streamTable<gtfs::flat::Translation>(
+          "translations.txt", false, &Parser::getTranslationFlds,
+          &Parser::nextTranslation,
+          [&](const gtfs::flat::Translation& t, int32_t, const std::string&) {
+            v->translation(t);
+          });
+    }
+  } catch (...) {
+    // deliver the warnings raised before the error
+    _deferWarnings = false;
+    flushWarnings();
+    throw;
+  }
+
+  _deferWarnings = false;
+  flushWarnings();
+
+  return true;
+}
+
+// ____________________________________________________________________________
+template <typename T, typename FLDS>
+void Parser::streamTable(
+    const std::string& file, bool required, FLDS (*getFlds)(CsvParser*),
+    bool (Parser::*next)(CsvParser*, T*, const FLDS&) const,
+    const std::function<void(const T&, int32_t, const std::string&)>& cb)
+    const {
+  std::string curFile = _path + "/" + file;
+  try {
+    // members are inflated while they are read, to bound memory
+    auto csvp = getCsvParser(file, false);
+    if (!csvp->isGood()) {
+      if (required) fileNotFound(curFile);
+      return;
+    }
+
+    const std::string& path = csvp->getReadablePath();
+    parseChunked<T>(csvp.get(), getFlds(csvp.get()), next,
+                    [&](const T& t, int32_t line) { cb(t, line, path); },
+                    STREAM_CHUNK_SIZE);
+  } catch (const CsvParserException& e) {
+    throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
+  }
+}
+
+// ____________________________________________________________________________
+void Parser::checkRef(const IdSet* ids, const std::string& id,
+                      const char* what, const char* file, const char* field,
+                      int32_t line, const std::string& path) {
+  if (!ids || ids->has(id)) return;
+
+  std::stringstream msg;
+  msg << "no " << what << " with id '" << id << "' defined in " << file
+      << ", cannot reference here.";
+  throw ParserException(msg.str(), field, line, path);
+}
+
 // ____________________________________________________________________________
 inline gtfs::flat::TranslationFlds Parser::getTranslationFlds(CsvParser* csvp) {
   gtfs::flat::TranslationFlds t;
@@ -182,9 +564,14 @@ void Parser::parseAttributions(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
     RouteT* route = 0;
     TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* trip = 0;
 
+    // attributions of dropped entities are dropped, too
+    bool dropped = false;
+
     if (a.agencyId.size()) {
       agency = targetFeed->getAgencies().get(a.agencyId);
-      if (!agency) {
+      if (!agency && _dropped.agencies.has(a.agencyId)) {
+        dropped = true;
+      } else if (!agency) {
         std::stringstream msg;
         msg << "no agency with id '" << a.agencyId
             << "' defined in agency.txt, cannot "
@@ -196,7 +583,9 @@ void Parser::parseAttributions(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     if (a.tripId.size()) {
       trip = targetFeed->getTrips().get(a.tripId);
-      if (!trip) {
+      if (!trip && _dropped.trips.has(a.tripId)) {
+        dropped = true;
+      } else if (!trip) {
         std::stringstream msg;
         msg << "no trip with id '" << a.tripId
             << "' defined in trips.txt, cannot "
@@ -208,7 +597,9 @@ void Parser::parseAttributions(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     if (a.routeId.size()) {
       route = targetFeed->getRoutes().get(a.routeId);
-      if (!route) {
+      if (!route && _dropped.routes.has(a.routeId)) {
+        dropped = true;
+      } else if (!route) {
         std::stringstream msg;
         msg << "no route with id '" << a.routeId
             << "' defined in routes.txt, cannot "
@@ -218,6 +609,8 @@ void Parser::parseAttributions(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
       }
     }
 
+    if (dropped) continue;
+
     ad::cppgtfs::gtfs::Attribution<StopT, StopTimeT, ServiceT, RouteT, ShapeT>
         t(a.attributionId, agency, route, trip, a.organizationName,
           a.isProducer, a.isOperator, a.isAuthority, a.attributionUrl,
@@ -276,9 +669,14 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
     TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* fromTrip = 0;
     TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* toTrip = 0;
 
+    // transfers between dropped entities are dropped, too
+    bool dropped = false;
+
     if (ft.fromStop.size()) {
       fromStop = targetFeed->getStops().get(ft.fromStop);
-      if (!fromStop) {
+      if (!fromStop && _dropped.stops.has(ft.fromStop)) {
+        dropped = true;
+      } else if (!fromStop) {
         std::stringstream msg;
         msg << "no stop with id '" << ft.fromStop
             << "' defined in stops.txt, cannot "
@@ -290,7 +688,9 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     if (ft.toStop.size()) {
       toStop = targetFeed->getStops().get(ft.toStop);
-      if (!toStop) {
+      if (!toStop && _dropped.stops.has(ft.toStop)) {
+        dropped = true;
+      } else if (!toStop) {
         std::stringstream msg;
         msg << "no stop with id '" << ft.toStop
             << "' defined in stops.txt, cannot "
@@ -302,7 +702,9 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     if (ft.fromRoute.size()) {
       fromRoute = targetFeed->getRoutes().get(ft.fromRoute);
-      if (!fromRoute) {
+      if (!fromRoute && _dropped.routes.has(ft.fromRoute)) {
+        dropped = true;
+      } else if (!fromRoute) {
         std::stringstream msg;
         msg << "no route with id '" << ft.fromRoute
             << "' defined in routes.txt, cannot "
@@ -314,7 +716,9 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     if (ft.toRoute.size()) {
       toRoute = targetFeed->getRoutes().get(ft.toRoute);
-      if (!toRoute) {
+      if (!toRoute && _dropped.routes.has(ft.toRoute)) {
+        dropped = true;
+      } else if (!toRoute) {
         std::stringstream msg;
         msg << "no route with id '" << ft.toRoute
             << "' defined in routes.txt, cannot "
@@ -326,7 +730,9 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     if (ft.fromTrip.size()) {
       fromTrip = targetFeed->getTrips().get(ft.fromTrip);
-      if (!fromTrip) {
+      if (!fromTrip && _dropped.trips.has(ft.fromTrip)) {
+        dropped = true;
+      } else if (!fromTrip) {
         std::stringstream msg;
         msg << "no trip with id '" << ft.fromTrip
             << "' defined in trips.txt, cannot "
@@ -338,7 +744,9 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     if (ft.toTrip.size()) {
       toTrip = targetFeed->getTrips().get(ft.toTrip);
-      if (!toTrip) {
+      if (!toTrip && _dropped.trips.has(ft.toTrip)) {
+        dropped = true;
+      } else if (!toTrip) {
         std::stringstream msg;
         msg << "no trip with id '" << ft.toTrip
             << "' defined in trips.txt, cannot "
@@ -348,6 +756,8 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
       }
     }
 
+    if (dropped) continue;
+
     Transfer<StopT, StopTimeT, ServiceT, RouteT, ShapeT> t(
         fromStop, toStop, fromRoute, toRoute, fromTrip, toTrip, ft.type,
         ft.tTime);
@@ -391,7 +801,9 @@ void Parser::parseFrequencies(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
     gtfs::Frequency f(ff.startTime, ff.endTime, ff.headwaySecs, ff.exactTimes);
 
     auto trip = targetFeed->getTrips().get(ff.tripId);
-    if (!trip) {
+    if (!trip && _dropped.trips.has(ff.tripId)) {
+      continue;
+    } else if (!trip) {
       std::stringstream msg;
       msg << "trip '" << ff.tripId << "' not found.";
       throw ParserException(msg.str(), "trip_id", csvp->getCurLine(),
@@ -446,7 +858,10 @@ void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed,
 
     if (!ff.agency.empty()) {
       agency = targetFeed->getAgencies().get(ff.agency);
-      if (!agency) {
+      if (!agency && _dropped.agencies.has(ff.agency)) {
+        _dropped.fares.add(ff.id);
+        continue;
+      } else if (!agency) {
         std::stringstream msg;
         msg << "no agency with id '" << ff.agency << "' defined, cannot "
             << "reference here.";
@@ -496,6 +911,19 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
     Fare<RouteT>* fare = targetFeed->getFares().get(fr.fare);
     RouteT* route = targetFeed->getRoutes().get(fr.route);
 
+    // rules of dropped fares, routes or zones are dropped, too
+    auto droppedZone = [&](const std::string& zone) {
+      return !zone.empty() && !targetFeed->getZones().count(zone) &&
+             _dropped.zones.has(zone);
+    };
+
+    if ((!fare && _dropped.fares.has(fr.fare)) ||
+        (!fr.route.empty() && !route && _dropped.routes.has(fr.route)) ||
+        droppedZone(fr.originZone) || droppedZone(fr.destZone) ||
+        droppedZone(fr.containsZone)) {
+      continue;
+    }
+
     if (!fare) {
       std::stringstream msg;
       msg << "no fare with id '" << fr.fare << "' defined, cannot "
@@ -721,6 +1149,12 @@ void Parser::parsePathways(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
     fromStop = targetFeed->getStops().get(fa.from_stop_id);
     toStop = targetFeed->getStops().get(fa.to_stop_id);
 
+    // pathways of dropped stops are dropped, too
+    if ((!fromStop && _dropped.stops.has(fa.from_stop_id)) ||
+        (!toStop && _dropped.stops.has(fa.to_stop_id))) {
+      continue;
+    }
+
     if (!fromStop) {
       std::stringstream msg;
       msg << "no stop with id '" << fa.from_stop_id
@@ -740,7 +1174,7 @@ void Parser::parsePathways(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
     }
 
     if ((typename PathwayT::Ref()) ==
-        (a = targetFeed->getPathways().add(gtfs::Pathway(
+        (a = targetFeed->getPathways().add(PathwayT(
              fa.id, fromStop, toStop, fa.pathway_mode, fa.is_bidirectional,
              fa.length, fa.traversal_time, fa.stair_count, fa.max_slope,
              fa.min_width, fa.signposted_as, fa.reversed_signposted_as)))) {
@@ -761,12 +1195,21 @@ void Parser::parseAgencies(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
   typename AgencyT::Ref a = (typename AgencyT::Ref());
   gtfs::flat::Agency fa;
   auto flds = getAgencyFlds(csvp);
+  gtfs::StringPool* pool = targetFeed->getStringPool();
+  typedef typename AgencyT::Text Text;
 
   while (nextAgency(csvp, &fa, flds)) {
+    if (!_opts.agencies.empty() && !_opts.agencies.count(fa.id)) {
+      _dropped.agencies.add(fa.id);
+      continue;
+    }
+
     if ((typename AgencyT::Ref()) ==
-        (a = targetFeed->getAgencies().add(
-             gtfs::Agency(fa.id, fa.name, fa.url, fa.timezone, fa.lang,
-                          fa.phone, fa.fare_url, fa.agency_email)))) {
+        (a = targetFeed->getAgencies().add(AgencyT(
+             fa.id, text<Text>(pool, fa.name), text<Text>(pool, fa.url),
+             text<Text>(pool, fa.timezone), text<Text>(pool, fa.lang),
+             text<Text>(pool, fa.phone), text<Text>(pool, fa.fare_url),
+             text<Text>(pool, fa.agency_email))))) {
       std::stringstream msg;
       msg << "'agency_id' must be dataset unique. Collision with id '" << fa.id
           << "')";
@@ -784,7 +1227,9 @@ void Parser::parseAgencies(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
     }
   }
 
-  if ((typename AgencyT::Ref()) == a) {
+  if ((typename AgencyT::Ref()) == a && _dropped.agencies.size()) {
+    _dropped.allAgencies = true;
+  } else if ((typename AgencyT::Ref()) == a) {
     throw ParserException(
         "the feed has no agency defined."
         " This is a required field.",
@@ -876,69 +1321,130 @@ inline bool Parser::nextStop(CsvParser* csvp, gtfs::flat::Stop* s,
 FEEDTPL
 void Parser::parseStops(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
   std::map<std::string, std::pair<size_t, std::string> > parentStations;
+  typedef std::vector<std::pair<std::string, std::string> > AddFlds;
+
+  // a stop without coordinates, held back until it is known whether its
+  // parent station is in the bounding box
+  struct PendingStop {
+    gtfs::flat::Stop fs;
+    size_t line;
+    AddFlds addFlds;
+    bool dropped;
+  };
+  std::vector<PendingStop> pending;
 
   gtfs::flat::Stop fs;
   auto flds = getStopFlds(csvp);
+  gtfs::StringPool* pool = targetFeed->getStringPool();
+  typedef typename StopT::Text Text;
 
-  while (nextStop(csvp, &fs, flds)) {
-    targetFeed->updateBox(fs.lat, fs.lng);
+  ParserBox box;
+
+  auto addStop = [&](const gtfs::flat::Stop& fs, size_t line,
+                     const AddFlds& addFlds) {
     Level* level = 0;
 
-    if (!fs.level_id.empty()) {
+    if (!fs.level_id.empty() && reads("levels.txt")) {
       level = targetFeed->getLevels().get(fs.level_id);
       if (!level) {
         std::stringstream msg;
         msg << "no stop with id '" << fs.level_id << "' defined, cannot "
             << "reference here.";
-        throw ParserException(msg.str(), "level_id", csvp->getCurLine(),
+        throw ParserException(msg.str(), "level_id", line,
                               csvp->getReadablePath());
       }
     }
 
-    const StopT& s =
-        StopT(fs.id, fs.code, fs.name, fs.desc, fs.lat, fs.lng, fs.zone_id,
-              fs.stop_url, fs.location_type, 0, fs.stop_timezone,
-              fs.wheelchair_boarding, fs.platform_code, level);
+    StopT s(fs.id, text<Text>(pool, fs.code), text<Text>(pool, fs.name),
+            text<Text>(pool, fs.desc), fs.lat, fs.lng,
+            text<Text>(pool, fs.zone_id), text<Text>(pool, fs.stop_url),
+            fs.location_type, 0, text<Text>(pool, fs.stop_timezone),
+            fs.wheelchair_boarding, text<Text>(pool, fs.platform_code), level);
 
     if (!fs.parent_station.empty()) {
       if (fs.location_type == gtfs::flat::Stop::LOCATION_TYPE::STATION) {
         throw ParserException(
             "a stop with location_type 'station' (1) cannot"
             " have a parent station",
-            "parent_station", csvp->getCurLine(), csvp->getReadablePath());
+            "parent_station", line, csvp->getReadablePath());
       }
 
       parentStations[s.getId()] =
-          std::pair<size_t, std::string>(csvp->getCurLine(), fs.parent_station);
+          std::pair<size_t, std::string>(line, fs.parent_station);
     }
 
     targetFeed->getZones().insert(fs.zone_id);
 
-    if (!targetFeed->getStops().add(s)) {
+    if (!targetFeed->getStops().add(std::move(s))) {
       std::stringstream msg;
       msg << "'stop_id' must be dataset unique. Collision with id '"
-          << s.getId() << "')";
-      throw ParserException(msg.str(), "stop_id", csvp->getCurLine(),
+          << fs.id << "')";
+      throw ParserException(msg.str(), "stop_id", line,
                             csvp->getReadablePath());
     }
 
+    for (const auto& f : addFlds)
+      targetFeed->addStopAddFld(fs.id, f.first, f.second);
+  };
+
+  while (nextStop(csvp, &fs, flds)) {
+    // generic nodes and boarding areas may have no coordinates, see
+    // nextStop()
+    bool hasCoords = fs.lat != 99999 && fs.lng != 99999;
+
+    if (hasCoords && !keepStop(fs.lat, fs.lng)) {
+      _dropped.stops.add(fs.id);
+      if (!fs.zone_id.empty()) _dropped.zones.add(fs.zone_id);
+      continue;
+    }
+
+    AddFlds addFlds;
     if (_parseAdditionalFields) {
       // additional fields
       for (size_t fid : flds.addHeaders) {
         const auto& val = getString(*csvp, fid, "");
-        if (val.size())
-          targetFeed->addStopAddFld(fs.id, csvp->getFieldName(fid), val);
+        if (val.size()) addFlds.push_back({csvp->getFieldName(fid), val});
       }
     }
+
+    if (!hasCoords && _opts.useBox && !fs.parent_station.empty()) {
+      pending.push_back({fs, static_cast<size_t>(csvp->getCurLine()),
+                         std::move(addFlds), false});
+      continue;
+    }
+
+    if (hasCoords) box.update(fs.lat, fs.lng);
+    addStop(fs, csvp->getCurLine(), addFlds);
+  }
+
+  // stops without coordinates are kept or dropped together with their parent
+  // station, which may be such a stop itself
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto& p : pending) {
+      if (p.dropped || !_dropped.stops.has(p.fs.parent_station)) continue;
+      p.dropped = true;
+      changed = true;
+      _dropped.stops.add(p.fs.id);
+      if (!p.fs.zone_id.empty()) _dropped.zones.add(p.fs.zone_id);
+    }
+  }
+
+  for (const auto& p : pending) {
+    if (!p.dropped) addStop(p.fs, p.line, p.addFlds);
   }
 
   targetFeed->getStops().finalize();
+  addBox(targetFeed, box);
 
   // second pass to resolve parentStation pointers
   for (const auto& ps : parentStations) {
     StopT* parentStation = 0;
     parentStation = targetFeed->getStops().get(ps.second.second);
-    if (!parentStation) {
+    if (!parentStation && _dropped.stops.has(ps.second.second)) {
+      // the parent station is outside of the box
+      continue;
+    } else if (!parentStation) {
       std::stringstream msg;
       msg << "no stop with id '" << ps.second.second << "' defined, cannot "
           << "reference here.";
@@ -1011,13 +1517,19 @@ FEEDTPL
 void Parser::parseRoutes(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
   gtfs::flat::Route fr;
   auto flds = getRouteFlds(csvp);
+  gtfs::StringPool* pool = targetFeed->getStringPool();
+  typedef typename RouteT::Text Text;
 
   while (nextRoute(csvp, &fr, flds)) {
     typename AgencyT::Ref routeAgency = 0;
 
     if (!fr.agency.empty()) {
       routeAgency = targetFeed->getAgencies().get(fr.agency);
-      if ((typename AgencyT::Ref()) == routeAgency) {
+      if ((typename AgencyT::Ref()) == routeAgency &&
+          _dropped.agencies.has(fr.agency)) {
+        _dropped.routes.add(fr.id);
+        continue;
+      } else if ((typename AgencyT::Ref()) == routeAgency) {
         std::stringstream msg;
         msg << "no agency with id '" << fr.agency << "' defined, cannot "
             << "reference here.";
@@ -1026,10 +1538,18 @@ void Parser::parseRoutes(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
       }
     }
 
+    if ((fr.agency.empty() && _dropped.allAgencies) ||
+        (!_opts.routeTypes.empty() && !_opts.routeTypes.count(fr.type))) {
+      _dropped.routes.add(fr.id);
+      continue;
+    }
+
     if (!targetFeed->getRoutes().add(
-            RouteT(fr.id, routeAgency, fr.short_name, fr.long_name, fr.desc,
-                   fr.type, fr.url, fr.color, fr.text_color, fr.sort_order,
-                   fr.continuous_pickup, fr.continuous_drop_off))) {
+            RouteT(fr.id, routeAgency, text<Text>(pool, fr.short_name),
+                   text<Text>(pool, fr.long_name), text<Text>(pool, fr.desc),
+                   fr.type, text<Text>(pool, fr.url), fr.color,
+                   fr.text_color, fr.sort_order, fr.continuous_pickup,
+                   fr.continuous_drop_off))) {
       std::stringstream msg;
       msg << "'route_id' must be dataset unique. Collision with id '" << fr.id
           << "')";
@@ -1207,12 +1727,21 @@ FEEDTPL
 void Parser::parseTrips(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
   gtfs::flat::Trip ft;
   auto flds = getTripFlds(csvp);
+  gtfs::StringPool* pool = targetFeed->getStringPool();
+  typedef typename RouteT::Text Text;
+
+  // the services already checked against the date window, and those
+  // without an active day in it
+  IdSet checkedServices, idleServices;
 
   while (nextTrip(csvp, &ft, flds)) {
     RouteT* tripRoute = 0;
 
     tripRoute = targetFeed->getRoutes().get(ft.route);
-    if (!tripRoute) {
+    if (!tripRoute && _dropped.routes.has(ft.route)) {
+      _dropped.trips.add(ft.id);
+      continue;
+    } else if (!tripRoute) {
       std::stringstream msg;
       msg << "no route with id '" << ft.route << "' defined, cannot "
           << "reference here.";
@@ -1222,7 +1751,7 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
 
     typename ShapeT::Ref tripShape = (typename ShapeT::Ref());
 
-    if (!ft.shape.empty()) {
+    if (!ft.shape.empty() && reads("shapes.txt")) {
       tripShape = targetFeed->getShapes().getRef(ft.shape);
       if (tripShape == (typename ShapeT::Ref())) {
         std::stringstream msg;
@@ -1244,11 +1773,25 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
                             csvp->getReadablePath());
     }
 
+    if (_opts.useDates) {
+      if (!checkedServices.has(ft.service)) {
+        checkedServices.add(ft.service);
+        const ServiceT* s = targetFeed->getServices().get(ft.service);
+        if (s && !s->isActiveBetween(_opts.from, _opts.to))
+          idleServices.add(ft.service);
+      }
+      if (idleServices.has(ft.service)) {
+        _dropped.trips.add(ft.id);
+        continue;
+      }
+    }
+
     if (typename TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>::Ref() ==
         targetFeed->getTrips().add(
             TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>(
-                ft.id, tripRoute, tripService, ft.headsign, ft.short_name,
-                ft.dir, ft.block_id, tripShape, ft.wc, ft.ba))) {
+                ft.id, tripRoute, tripService, text<Text>(pool, ft.headsign),
+                text<Text>(pool, ft.short_name), ft.dir,
+                text<Text>(pool, ft.block_id), tripShape, ft.wc, ft.ba))) {
       std::stringstream msg;
       msg << "'trip_id' must be dataset unique. Collision with id '"
           << getString(*csvp, flds.tripIdFld) << "')";
@@ -1318,6 +1861,7 @@ void Parser::parseStops(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("stops.txt");
     if (!csvp->isGood()) fileNotFound(curFile);
     parseStops(targetFeed, csvp.get());
+    countTable(*csvp);
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
   }
@@ -1331,6 +1875,7 @@ void Parser::parseRoutes(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("routes.txt");
     if (!csvp->isGood()) fileNotFound(curFile);
     parseRoutes(targetFeed, csvp.get());
+    countTable(*csvp);
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
   }
@@ -1344,6 +1889,7 @@ void Parser::parseCalendar(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("calendar.txt");
     if (csvp->isGood()) {
       parseCalendar(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1358,6 +1904,7 @@ void Parser::parseCalendarDates(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("calendar_dates.txt");
     if (csvp->isGood()) {
       parseCalendarDates(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1373,6 +1920,7 @@ void Parser::parseFeedInfo(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("feed_info.txt");
     if (csvp->isGood()) {
       parseFeedInfo(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1387,6 +1935,7 @@ void Parser::parsePathways(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("pathways.txt");
     if (csvp->isGood()) {
       parsePathways(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1401,6 +1950,7 @@ void Parser::parseLevels(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("levels.txt");
     if (csvp->isGood()) {
       parseLevels(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1415,6 +1965,7 @@ void Parser::parseAgencies(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("agency.txt");
     if (!csvp->isGood()) fileNotFound(curFile);
     parseAgencies(targetFeed, csvp.get());
+    countTable(*csvp);
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
   }
@@ -1428,6 +1979,7 @@ void Parser::parseShapes(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("shapes.txt");
     if (csvp->isGood()) {
       parseShapes(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1442,6 +1994,7 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("trips.txt");
     if (!csvp->isGood()) fileNotFound(curFile);
     parseTrips(targetFeed, csvp.get());
+    countTable(*csvp);
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
   }
@@ -1455,6 +2008,7 @@ void Parser::parseStopTimes(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("stop_times.txt");
     if (!csvp->isGood()) fileNotFound(curFile);
     parseStopTimes(targetFeed, csvp.get());
+    countTable(*csvp);
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
   }
@@ -1468,6 +2022,7 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("fare_rules.txt");
     if (csvp->isGood()) {
       parseFareRules(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1482,6 +2037,7 @@ void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("fare_attributes.txt");
     if (csvp->isGood()) {
       parseFareAttributes(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1496,6 +2052,7 @@ void Parser::parseTranslations(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("translations.txt");
     if (csvp->isGood()) {
       parseTranslations(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1510,6 +2067,7 @@ void Parser::parseAttributions(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("attributions.txt");
     if (csvp->isGood()) {
       parseAttributions(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1524,6 +2082,7 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("transfers.txt");
     if (csvp->isGood()) {
       parseTransfers(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1538,6 +2097,7 @@ void Parser::parseFrequencies(gtfs::FEEDB* targetFeed) const {
     auto csvp = getCsvParser("frequencies.txt");
     if (csvp->isGood()) {
       parseFrequencies(targetFeed, csvp.get());
+      countTable(*csvp);
     }
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(), curFile);
@@ -1547,29 +2107,95 @@ void Parser::parseFrequencies(gtfs::FEEDB* targetFeed) const {
 // ____________________________________________________________________________
 FEEDTPL
 void Parser::parseShapes(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
-  gtfs::flat::ShapePoint fp;
   auto flds = getShapeFlds(csvp);
+  ParserBox box;
 
-  while (nextShapePoint(csvp, &fp, flds)) {
-    if (!targetFeed->getShapes().has(fp.id)) {
-      targetFeed->getShapes().add(ShapeT(fp.id));
-    }
+  // as for stop times, points are appended to their shapes, and shapes
+  // which receive points out of order are sorted and checked once
+  std::unordered_map<ShapeT*, std::vector<std::pair<uint32_t, int32_t>>>
+      unsorted;
 
-    auto s = targetFeed->getShapes().get(fp.id);
-    targetFeed->updateBox(fp.lat, fp.lng);
+  auto firstCollision = [&]() {
+    int32_t ret = -1;
+    for (auto& u : unsorted) {
+      std::vector<uint32_t> seqs;
+      for (const auto& p : u.first->getPoints()) seqs.push_back(p.seq);
 
-    if (s) {
-      if (!s->addPoint(ShapePoint(fp.lat, fp.lng, fp.travelDist, fp.seq))) {
-        throw ParserException(
-            "shape_pt_sequence collision,"
-            "shape_pt_sequence has "
-            "to be increasing for a single shape.",
-            "shape_pt_sequence", csvp->getCurLine(), csvp->getReadablePath());
-      }
+      int32_t line = firstSeqCollision(&u.second, &seqs);
+      if (line > -1 && (ret < 0 || line < ret)) ret = line;
     }
-  }
+    return ret;
+  };
+
+  auto collision = [&](int32_t line) {
+    return ParserException(
+        "shape_pt_sequence collision,"
+        "shape_pt_sequence has "
+        "to be increasing for a single shape.",
+        "shape_pt_sequence", line, csvp->getReadablePath());
+  };
+
+  // the points of a shape are usually given in consecutive rows
+  std::string lastId;
+  ShapeT* last = 0;
+
+  try {
+    parseChunked<gtfs::flat::ShapePoint>(
+        csvp, flds, &Parser::nextShapePoint,
+        [&](const gtfs::flat::ShapePoint& fp, int32_t line) {
+          ShapeT* s = last;
+
+          if (!s || fp.id != lastId) {
+            if (!targetFeed->getShapes().has(fp.id)) {
+              targetFeed->getShapes().add(ShapeT(fp.id));
+            }
+
+            s = targetFeed->getShapes().get(fp.id);
+            last = s;
+            lastId = fp.id;
+          }
+
+          box.update(fp.lat, fp.lng);
+
+          if (s) {
+            const auto& pts = s->getPoints();
+            if (!pts.empty() && fp.seq <= pts.back().seq) {
+              unsorted[s].push_back({fp.seq, line});
+            } else if (!unsorted.empty()) {
+              auto u = unsorted.find(s);
+              if (u != unsorted.end()) u->second.push_back({fp.seq, line});
+            }
+
+            s->appendPoint(ShapePoint(fp.lat, fp.lng, fp.travelDist, fp.seq));
+          }
+        });
+  } catch (...) {
+    // a collision in the lines read so far comes first
+    int32_t line = firstCollision();
+    if (line > -1) throw collision(line);
+    throw;
+  }
+
+  int32_t line = firstCollision();
+  if (line > -1) throw collision(line);
+
+  for (auto& u : unsorted) u.first->sortPoints();
 
   targetFeed->getShapes().finalize();
+  addBox(targetFeed, box);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::addBox(gtfs::FEEDB* targetFeed, const ParserBox& box) const {
+  // coordinates which were never updated are passed as NaN, which is ignored
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  bool lat = box.minLat <= box.maxLat;
+  bool lng = box.minLng <= box.maxLng;
+
+  std::lock_guard<std::mutex> lock(_boxMutex);
+  targetFeed->updateBox(lat ? box.minLat : nan, lng ? box.minLng : nan);
+  targetFeed->updateBox(lat ? box.maxLat : nan, lng ? box.maxLng : nan);
 }
 
 // ____________________________________________________________________________
@@ -1600,8 +2226,8 @@ inline bool Parser::nextStopTime(CsvParser* csvp, gtfs::flat::StopTime* s,
     if (s->at.empty() && !s->dt.empty()) s->at = s->dt;
     if (s->dt.empty() && !s->at.empty()) s->dt = s->at;
 
-    s->trip = getString(*csvp, flds.tripIdFld);
-    s->s = getString(*csvp, flds.stopIdFld);
+    getString(*csvp, flds.tripIdFld, &s->trip);
+    getString(*csvp, flds.stopIdFld, &s->s);
     s->sequence = getRangeInteger(*csvp, flds.stopSequenceFld, 0, UINT32_MAX);
     s->headsign = getString(*csvp, flds.stopHeadsignFld, "");
     s->pickupType = static_cast<gtfs::flat::StopTime::PU_DO_TYPE>(
@@ -1648,54 +2274,188 @@ inline bool Parser::nextStopTime(CsvParser* csvp, gtfs::flat::StopTime* s,
 // ____________________________________________________________________________
 FEEDTPL
 void Parser::parseStopTimes(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
-  gtfs::flat::StopTime fst;
+  typedef TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT> TripT;
+
   auto flds = getStopTimeFlds(csvp);
 
-  while (nextStopTime(csvp, &fst, flds)) {
-    StopT* stop = 0;
-    TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* trip = 0;
+  // Stop times are appended to their trips, which is all that is needed if
+  // they are sorted by stop_sequence within each trip. For trips which
+  // receive stop times out of order, the sequence and line of these rows
+  // are kept, and the trips are sorted and checked for stop_sequence
+  // collisions once.
+  std::unordered_map<TripT*, std::vector<std::pair<uint16_t, int32_t>>>
+      unsorted;
 
-    stop = targetFeed->getStops().get(fst.s);
-    trip = targetFeed->getTrips().get(fst.trip);
+  // the trips which received stop times
+  std::vector<TripT*> filled;
 
-    if (!stop) {
-      std::stringstream msg;
-      msg << "no stop with id '" << fst.s << "' defined in stops.txt, cannot "
-          << "reference here.";
-      throw ParserException(msg.str(), "stop_id", csvp->getCurLine(),
-                            csvp->getReadablePath());
-    }
+  gtfs::StringPool* pool = targetFeed->getStringPool();
 
-    if (!trip) {
-      std::stringstream msg;
-      msg << "no trip with id '" << fst.trip
-          << "' defined in trips.txt, cannot "
-          << "reference here.";
-      throw ParserException(msg.str(), "trip_id", csvp->getCurLine(),
-                            csvp->getReadablePath());
+  // returns the first line which repeats an earlier stop_sequence of its
+  // trip, or -1
+  auto firstCollision = [&]() {
+    int32_t ret = -1;
+    for (auto& u : unsorted) {
+      std::vector<uint16_t> seqs;
+      const auto& sts = u.first->getStopTimes();
+      for (size_t i = 0; i < sts.size(); i++) seqs.push_back(sts.getSeq(i));
+
+      int32_t line = firstSeqCollision(&u.second, &seqs);
+      if (line > -1 && (ret < 0 || line < ret)) ret = line;
     }
+    return ret;
+  };
+
+  auto collision = [&](int32_t line) {
+    return ParserException(
+        "stop_sequence collision, stop_sequence has "
+        "to be increasing for a single trip.",
+        "stop_sequence", line, csvp->getReadablePath());
+  };
+
+  // stop times are usually grouped by trip, so the trip of the previous
+  // row is kept. Stops are resolved through an interned map of the stops
+  // referenced so far.
+  std::string lastTripId;
+  TripT* lastTrip = 0;
+  bool lastTripDropped = false;
+  IdMap<StopT> stops;
 
-    StopTimeT<StopT> st(fst.at, fst.dt, stop, fst.sequence, fst.headsign,
-                        fst.pickupType, fst.dropOffType, fst.shapeDistTravelled,
-                        fst.isTimepoint, fst.continuousDropOff,
-                        fst.continuousPickup);
+  try {
+    parseChunked<gtfs::flat::StopTime>(
+        csvp, flds, &Parser::nextStopTime,
+        [&](const gtfs::flat::StopTime& fst, int32_t line) {
+          StopT* stop = stops.get(fst.s);
+
+          if (!stop) {
+            stop = targetFeed->getStops().get(fst.s);
+            if (stop) stops.add(fst.s, stop);
+          }
+
+          // ids are never empty
+          if (fst.trip != lastTripId) {
+            lastTrip = targetFeed->getTrips().get(fst.trip);
+            lastTripDropped = !lastTrip && _dropped.trips.has(fst.trip);
+            lastTripId = fst.trip;
+          }
+
+          TripT* trip = lastTrip;
+
+          if (!stop && !_dropped.stops.has(fst.s)) {
+            std::stringstream msg;
+            msg << "no stop with id '" << fst.s
+                << "' defined in stops.txt, cannot "
+                << "reference here.";
+            throw ParserException(msg.str(), "stop_id", line,
+                                  csvp->getReadablePath());
+          }
+
+          if (!trip && !lastTripDropped) {
+            std::stringstream msg;
+            msg << "no trip with id '" << fst.trip
+                << "' defined in trips.txt, cannot "
+                << "reference here.";
+            throw ParserException(msg.str(), "trip_id", line,
+                                  csvp->getReadablePath());
+          }
+
+          // rows of dropped stops or trips are dropped, too
+          if (!stop || !trip) return;
+
+          StopTimeT<StopT> st(
+              fst.at, fst.dt, stop, fst.sequence,
+              text<typename StopT::Text>(pool, fst.headsign), fst.pickupType,
+              fst.dropOffType, fst.shapeDistTravelled, fst.isTimepoint,
+              fst.continuousDropOff, fst.continuousPickup);
+
+          if (st.getArrivalTime() > st.getDepartureTime()) {
+            throw ParserException(
+                "arrival time '" + st.getArrivalTime().toString() +
+                    "' is later than departure time '" +
+                    st.getDepartureTime().toString() +
+                    "'. You cannot depart earlier than you arrive.",
+                "departure_time", line, csvp->getReadablePath());
+          }
+
+          auto& sts = trip->getStopTimes();
+          if (sts.empty()) {
+            filled.push_back(trip);
+          } else if (st.getSeq() <= sts.getSeq(sts.size() - 1)) {
+            unsorted[trip].push_back({st.getSeq(), line});
+          } else if (!unsorted.empty()) {
+            auto u = unsorted.find(trip);
+            if (u != unsorted.end()) u->second.push_back({st.getSeq(), line});
+          }
+
+          sts.push_back(st);
+        });
+  } catch (...) {
+    // a collision in the lines read so far comes first
+    int32_t line = firstCollision();
+    if (line > -1) throw collision(line);
+    throw;
+  }
+
+  int32_t line = firstCollision();
+  if (line > -1) throw collision(line);
+
+  for (auto& u : unsorted) u.first->getStopTimes().sort();
+
+  // the stop times of a trip grow by doubling their capacity
+  for (TripT* trip : filled) trip->getStopTimes().shrink_to_fit();
+}
 
-    if (st.getArrivalTime() > st.getDepartureTime()) {
-      throw ParserException("arrival time '" + st.getArrivalTime().toString() +
-                                "' is later than departure time '" +
-                                st.getDepartureTime().toString() +
-                                "'. You cannot depart earlier than you arrive.",
-                            "departure_time", csvp->getCurLine(),
-                            csvp->getReadablePath());
-    }
+// ___________________________________________________________________________
+template <typename S>
+int32_t Parser::firstSeqCollision(std::vector<std::pair<S, int32_t>>* rows,
+                                  std::vector<S>* seqs) {
+  std::sort(rows->begin(), rows->end());
+  std::sort(seqs->begin(), seqs->end());
 
-    if (!trip->addStopTime(st)) {
-      throw ParserException(
-          "stop_sequence collision, stop_sequence has "
-          "to be increasing for a single trip.",
-          "stop_sequence", csvp->getCurLine(), csvp->getReadablePath());
+  int32_t ret = -1;
+  for (size_t i = 0, j = 0; i < rows->size(); i = j) {
+    S seq = (*rows)[i].first;
+    while (j < rows->size() && (*rows)[j].first == seq) j++;
+
+    // the second occurrence collides, which is the first of the rows if the
+    // sequence number also occurs before them
+    auto all = std::equal_range(seqs->begin(), seqs->end(), seq);
+    int32_t line = -1;
+    if (static_cast<size_t>(all.second - all.first) > j - i)
+      line = (*rows)[i].second;
+    else if (j - i > 1)
+      line = (*rows)[i + 1].second;
+
+    if (line > -1 && (ret < 0 || line < ret)) ret = line;
+  }
+
+  return ret;
+}
+
+// ___________________________________________________________________________
+void Parser::setParseOptions(const ParseOptions& opts) {
+  for (const char* f :
+       {"agency.txt", "stops.txt", "routes.txt", "trips.txt", "stop_times.txt",
+        "calendar.txt", "calendar_dates.txt"}) {
+    if (opts.skipTables.count(f)) {
+      throw ParserException("required table cannot be skipped", "", -1,
+                            _path + "/" + f);
     }
   }
+  _opts = opts;
+}
+
+// ___________________________________________________________________________
+bool Parser::reads(const std::string& file) const {
+  // fare rules cannot be resolved without their fares
+  if (file == "fare_rules.txt" && !reads("fare_attributes.txt")) return false;
+  return !_opts.skipTables.count(file);
+}
+
+// ___________________________________________________________________________
+bool Parser::keepStop(double lat, double lng) const {
+  return !_opts.useBox || (lat >= _opts.minLat && lat <= _opts.maxLat &&
+                           lng >= _opts.minLng && lng <= _opts.maxLng);
 }
 
 // ___________________________________________________________________________
@@ -1705,24 +2465,36 @@ void Parser::fileNotFound(const std::string& file) const {
 
 // ___________________________________________________________________________
 std::string Parser::getString(const CsvParser& csv, size_t field) const {
-  const char* r = csv.getTString(field);
-  if (r[0] == 0) {
+  CsvField r = csv.getField(field);
+  if (r.len == 0) {
     throw ParserException("expected non-empty string", csv.getFieldName(field),
                           csv.getCurLine(), csv.getReadablePath());
   }
-  return r;
+  return std::string(r.begin, r.len);
 }
 
 // ___________________________________________________________________________
 std::string Parser::getString(const CsvParser& csv, size_t field,
                               const std::string& def) const {
   if (field < csv.getNumColumns() && !csv.fieldIsEmpty(field)) {
-    return csv.getTString(field);
+    CsvField r = csv.getField(field);
+    return std::string(r.begin, r.len);
   }
 
   return def;
 }
 
+// ___________________________________________________________________________
+void Parser::getString(const CsvParser& csv, size_t field,
+                       std::string* ret) const {
+  CsvField r = csv.getField(field);
+  if (r.len == 0) {
+    throw ParserException("expected non-empty string", csv.getFieldName(field),
+                          csv.getCurLine(), csv.getReadablePath());
+  }
+  ret->assign(r.begin, r.len);
+}
+
 // ___________________________________________________________________________
 double Parser::getDouble(const CsvParser& csv, size_t field) const {
   return csv.getDouble(field);
@@ -1761,18 +2533,16 @@ int64_t Parser::getRangeInteger(const CsvParser& csv, size_t field,
     ret = csv.getLong(field);
 
     if (ret < minv || ret > maxv) {
-      std::stringstream msg;
-      msg << "expected integer in range [" << minv << "," << maxv << "]";
       if (_strict) {
+        std::stringstream msg;
+        msg << "expected integer in range [" << minv << "," << maxv << "]";
         throw ParserException(msg.str(), csv.getFieldName(field),
                               csv.getCurLine(), csv.getReadablePath());
-      } else {
-        if (_warnCb)
-          _warnCb(ParserException(msg.str(), csv.getFieldName(field),
-                                  csv.getCurLine(), csv.getReadablePath())
-                      .what());
-        return def;
       }
+
+      warn(csv, field, csv.getCurLine(), ParserWarning::INT_OUT_OF_RANGE,
+           minv, maxv, 0);
+      return def;
     }
 
     return ret;
@@ -1784,55 +2554,581 @@ int64_t Parser::getRangeInteger(const CsvParser& csv, size_t field,
 // ___________________________________________________________________________
 uint32_t Parser::getColorFromHexString(const CsvParser& csv, size_t field,
                                        const std::string& def) const {
-  std::string color_string;
+  const char* colorStr = "";
+  char buf[16];
+
+  if (field < csv.getNumColumns())
+    colorStr = csv.getTString(field, buf, sizeof(buf));
+  if (colorStr[0] == 0) colorStr = def.c_str();
+  if (colorStr[0] == 0) return std::numeric_limits<uint32_t>::max();
+
+  uint32_t ret = 0;
+  if (decodeHexColor(colorStr, &ret)) return ret;
 
-  if (field < csv.getNumColumns()) {
-    color_string = csv.getTString(field);
+  if (_strict) {
+    std::stringstream msg;
+    msg << "expected a 6-character hexadecimal color string, found '"
+        << colorStr << "' instead.";
+    throw ParserException(msg.str(), csv.getFieldName(field), csv.getCurLine(),
+                          csv.getReadablePath());
   }
 
-  if (color_string.empty()) color_string = def;
+  warn(csv, field, csv.getCurLine(), ParserWarning::INVALID_HEX_COLOR, 0, 0,
+       colorStr);
 
-  if (color_string.empty()) return std::numeric_limits<uint32_t>::max();
+  ret = 0;
+  decodeHexColor(def.c_str(), &ret);
+  return ret;
+}
 
-  size_t chars_processed = 0;
-  uint32_t ret = 0;
+// ___________________________________________________________________________
+bool Parser::decodeHexColor(const char* val, uint32_t* ret) {
+  uint32_t c = 0;
+  size_t i = 0;
+  for (; i < 6 && val[i]; i++) {
+    char h = val[i];
+    if (h >= '0' && h <= '9')
+      c = (c << 4) | (h - '0');
+    else if (h >= 'a' && h <= 'f')
+      c = (c << 4) | (h - 'a' + 10);
+    else if (h >= 'A' && h <= 'F')
+      c = (c << 4) | (h - 'A' + 10);
+    else
+      return false;
+  }
+
+  if (i != 6 || val[i] != 0) return false;
+
+  *ret = c;
+  return true;
+}
+
+// ___________________________________________________________________________
+void Parser::warn(const CsvParser& csv, size_t field, int32_t line,
+                  ParserWarning::CODE code, int64_t minv, int64_t maxv,
+                  const char* val) const {
+  if (!_warnCb) return;
+
+  // collected per chunk and added in file order later on, fld is the column
+  // until then
+  ParserWarnings* w = chunkWarnings();
+  uint32_t fld = field;
+
+  if (!w) {
+    w = taskWarnings();
+    if (!w) w = &_warns;
+
+    if (csv.getReadablePath() != w->path) {
+      w->path = csv.getReadablePath();
+      w->fieldIdx.clear();
+    }
 
+    if (w->fieldIdx.size() <= field)
+      w->fieldIdx.resize(field + 1, std::numeric_limits<uint32_t>::max());
+
+    if (w->fieldIdx[field] == std::numeric_limits<uint32_t>::max()) {
+      w->fieldIdx[field] = w->fields.size();
+      w->fields.push_back({w->path, csv.getFieldName(field), 0});
+    }
+
+    fld = w->fieldIdx[field];
+    if (w->fields[fld].count++ >= _maxWarnsPerField) return;
+  }
+
+  ParserWarning r;
+  r.code = code;
+  r.fld = fld;
+  r.line = line;
+  r.val = w->vals.size();
+  r.minv = minv;
+  r.maxv = maxv;
+  if (val) w->vals.append(val, strlen(val) + 1);
+
+  if (w == &_warns && !_deferWarnings) {
+    _warnCb(formatWarning(r));
+    w->vals.resize(r.val);
+    return;
+  }
+
+  w->warnings.push_back(r);
+}
+
+// ___________________________________________________________________________
+std::string Parser::formatWarning(const ParserWarning& w) const {
+  const ParserWarningField& f = _warns.fields[w.fld];
+  std::stringstream msg;
+
+  switch (w.code) {
+    case ParserWarning::INT_OUT_OF_RANGE:
+      msg << "expected integer in range [" << w.minv << "," << w.maxv << "]";
+      break;
+    case ParserWarning::INVALID_HEX_COLOR:
+      msg << "expected a 6-character hexadecimal color string, found '"
+          << _warns.vals.data() + w.val << "' instead.";
+      break;
+  }
+
+  return ParserException(msg.str(), f.fieldName, w.line, f.fileName).what();
+}
+
+// ___________________________________________________________________________
+ParserWarnings*& Parser::chunkWarnings() {
+  static thread_local ParserWarnings* sink = 0;
+  return sink;
+}
+
+// ___________________________________________________________________________
+ParserWarnings*& Parser::taskWarnings() {
+  static thread_local ParserWarnings* target = 0;
+  return target;
+}
+
+// ___________________________________________________________________________
+ParserTableStats*& Parser::tableStats() {
+  static thread_local ParserTableStats* target = 0;
+  return target;
+}
+
+// ___________________________________________________________________________
+size_t*& Parser::taskThreads() {
+  static thread_local size_t* taken = 0;
+  return taken;
+}
+
+// ___________________________________________________________________________
+size_t Parser::takeThreads(size_t n, bool wait) const {
+  std::unique_lock<std::mutex> lock(_threadsMutex);
+  if (wait) {
+    _threadsCv.wait(lock, [&] { return _threadsInUse < _numThreads; });
+  }
+  size_t ret = std::min(n, _numThreads - std::min(_threadsInUse, _numThreads));
+  _threadsInUse += ret;
+  return ret;
+}
+
+// ___________________________________________________________________________
+void Parser::giveThreads(size_t n) const {
+  if (!n) return;
+  {
+    std::unique_lock<std::mutex> lock(_threadsMutex);
+    _threadsInUse -= n;
+  }
+  _threadsCv.notify_all();
+}
+
+// ___________________________________________________________________________
+bool Parser::readThreaded() const {
+  if (_numThreads < 2) return false;
+
+  // outside of runTasks(), tables are read one at a time
+  if (!taskThreads()) return true;
+
+  if (!takeThreads(1, false)) return false;
+  (*taskThreads())++;
+  return true;
+}
+
+#ifdef LIBZIP_FOUND
+// ___________________________________________________________________________
+zip**& Parser::taskArchive() {
+  static thread_local zip** za = 0;
+  return za;
+}
+
+// ___________________________________________________________________________
+zip* Parser::archive() const {
+  zip** za = taskArchive();
+  if (!za) return _za;
+
+  if (!*za) {
+    *za = ZipCsvParser::openArchive(_path, _zipData, _zipSize);
+    if (!*za) throw ParserException("Cannot open ZIP file", "", -1, _path);
+  }
+  return *za;
+}
+
+// ___________________________________________________________________________
+const ZipCsvParser::StoredMember* Parser::storedMember(
+    zip* za, const std::string& file) const {
+  if (_stored.empty()) return 0;
+
+  auto fi = zip_name_locate(za, file.c_str(), ZIP_FL_NOCASE | ZIP_FL_NODIR);
+  if (fi < 0) return 0;
+
+  auto it = _stored.find(fi);
+  if (it == _stored.end()) return 0;
+  return &it->second;
+}
+#endif
+
+// ___________________________________________________________________________
+void Parser::measure(ParserTableStats* stats,
+                     const std::function<void()>& task) const {
+  double wall = wallMs();
+  double cpu = threadCpuMs();
+  size_t rss = residentMemory();
+
+  tableStats() = stats;
   try {
-    ret = std::stoul("0x" + color_string, &chars_processed, 16);
-  } catch (const std::exception& e) {
-    std::stringstream msg;
-    msg << "expected a 6-character hexadecimal color string, found '"
-        << color_string << "' instead. (Error while parsing was: " << e.what()
-        << ")";
-    if (_strict) {
-      throw ParserException(msg.str(), csv.getFieldName(field),
-                            csv.getCurLine(), csv.getReadablePath());
-    } else {
-      if (_warnCb)
-        _warnCb(ParserException(msg.str(), csv.getFieldName(field),
-                                csv.getCurLine(), csv.getReadablePath())
-                    .what());
-      return std::stoul("0x" + def, &chars_processed, 16);
+    task();
+  } catch (...) {
+    tableStats() = 0;
+    throw;
+  }
+  tableStats() = 0;
+
+  stats->wallMs = wallMs() - wall;
+  stats->readMs = stats->wallMs - stats->openMs - stats->insertMs;
+  stats->cpuMs += threadCpuMs() - cpu;
+  stats->rssGrowth = static_cast<int64_t>(residentMemory()) -
+                     static_cast<int64_t>(rss);
+
+  if (_statsCb) {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _statsCb(*stats);
+  }
+}
+
+// ___________________________________________________________________________
+void Parser::countTable(const CsvParser& csv) {
+  ParserTableStats* stats = tableStats();
+  if (!stats) return;
+
+  // without the header
+  if (csv.getNumLines() > 1) stats->rows += csv.getNumLines() - 1;
+  stats->bytes += csv.getNumBytes();
+}
+
+// ___________________________________________________________________________
+template <>
+inline std::string Parser::text(gtfs::StringPool*, const std::string& s) {
+  return s;
+}
+
+// ___________________________________________________________________________
+template <>
+inline gtfs::PoolString Parser::text(gtfs::StringPool* pool,
+                                     const std::string& s) {
+  return pool->get(s);
+}
+
+// ___________________________________________________________________________
+size_t Parser::residentMemory() {
+  // only available on Linux
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0, resident = 0;
+  if (!(statm >> size >> resident)) return 0;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+// ___________________________________________________________________________
+size_t Parser::peakResidentMemory() {
+  rusage r;
+  if (getrusage(RUSAGE_SELF, &r) != 0) return 0;
+#ifdef __APPLE__
+  return r.ru_maxrss;
+#else
+  return r.ru_maxrss * 1024;
+#endif
+}
+
+// ___________________________________________________________________________
+double Parser::threadCpuMs() {
+  timespec t;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) != 0) return 0;
+  return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+// ___________________________________________________________________________
+double Parser::processCpuMs() {
+  rusage r;
+  if (getrusage(RUSAGE_SELF, &r) != 0) return 0;
+  return (r.ru_utime.tv_sec + r.ru_stime.tv_sec) * 1000.0 +
+         (r.ru_utime.tv_usec + r.ru_stime.tv_usec) / 1000.0;
+}
+
+// ___________________________________________________________________________
+double Parser::wallMs() {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// ___________________________________________________________________________
+void Parser::mergeWarnings(const ParserWarnings& w) const {
+  uint32_t offset = _warns.fields.size();
+  uint32_t valOffset = _warns.vals.size();
+  _warns.fields.insert(_warns.fields.end(), w.fields.begin(), w.fields.end());
+  _warns.vals += w.vals;
+
+  for (const auto& warning : w.warnings) {
+    _warns.warnings.push_back(warning);
+    _warns.warnings.back().fld += offset;
+    _warns.warnings.back().val += valOffset;
+  }
+
+  // the next warning starts a new file
+  _warns.path.clear();
+  _warns.fieldIdx.clear();
+}
+
+// ___________________________________________________________________________
+void Parser::runTasks(const std::vector<std::function<void()>>& tasks,
+                      const std::vector<std::vector<size_t>>& deps) const {
+  if (_numThreads < 2) {
+    for (const auto& t : tasks) t();
+    return;
+  }
+
+  struct State {
+    ParserWarnings warnings;
+    std::exception_ptr err;
+    bool started = false;
+    bool done = false;
+  };
+
+  std::vector<State> st(tasks.size());
+
+  std::mutex m;
+  std::condition_variable cv;
+  size_t running = 0;
+
+  // the first failed task. Tasks after it would not have run sequentially,
+  // and are not started anymore.
+  size_t failed = tasks.size();
+
+  auto nextReady = [&]() {
+    for (size_t i = 0; i < failed; i++) {
+      if (st[i].started) continue;
+      bool ready = true;
+      for (size_t d : deps[i]) ready = ready && st[d].done;
+      if (ready) return i;
+    }
+    return tasks.size();
+  };
+
+  auto work = [&]() {
+#ifdef LIBZIP_FOUND
+    zip* za = 0;
+    taskArchive() = &za;
+#endif
+    std::unique_lock<std::mutex> lock(m);
+    while (true) {
+      size_t i = tasks.size();
+      cv.wait(lock, [&] {
+        i = nextReady();
+        return i < tasks.size() || running == 0;
+      });
+      if (i == tasks.size()) break;
+
+      st[i].started = true;
+      running++;
+      lock.unlock();
+
+      // the threads a task starts are taken from the same budget, and
+      // given back when it ends
+      takeThreads(1, true);
+      size_t taken = 0;
+      taskThreads() = &taken;
+
+      taskWarnings() = &st[i].warnings;
+      try {
+        tasks[i]();
+      } catch (...) {
+        st[i].err = std::current_exception();
+      }
+      taskWarnings() = 0;
+
+      taskThreads() = 0;
+      giveThreads(1 + taken);
+
+      lock.lock();
+      st[i].done = true;
+      running--;
+      if (st[i].err && i < failed) failed = i;
+      cv.notify_all();
+    }
+#ifdef LIBZIP_FOUND
+    taskArchive() = 0;
+    if (za) zip_close(za);
+#endif
+  };
+
+  size_t numThreads = std::min(_numThreads, tasks.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numThreads; i++) threads.push_back(std::thread(work));
+  work();
+  for (auto& t : threads) t.join();
+
+  for (size_t i = 0; i < tasks.size() && i <= failed; i++)
+    mergeWarnings(st[i].warnings);
+
+  if (failed < tasks.size()) std::rethrow_exception(st[failed].err);
+}
+
+// ___________________________________________________________________________
+template <typename T, typename FLDS>
+void Parser::parseChunked(
+    CsvParser* csvp, const FLDS& flds,
+    bool (Parser::*next)(CsvParser*, T*, const FLDS&) const,
+    const std::function<void(const T&, int32_t)>& add,
+    size_t chunkSize) const {
+  // the calling thread merges the chunks, the workers take the threads
+  // left
+  std::vector<CsvChunk> chunks;
+  size_t numThreads = 0;
+  if (_numThreads > 1) numThreads = takeThreads(_numThreads - 1, false);
+  if (numThreads) chunks = csvp->getChunks(chunkSize);
+
+  if (chunks.size() < numThreads) {
+    giveThreads(numThreads - chunks.size());
+    numThreads = chunks.size();
+  }
+
+  if (chunks.empty()) {
+    T t;
+    while ((this->*next)(csvp, &t, flds)) add(t, csvp->getCurLine());
+    return;
+  }
+
+  struct Result {
+    std::vector<T> rows;
+    std::vector<int32_t> lines;
+    ParserWarnings warnings;
+    std::exception_ptr err;
+    bool done = false;
+  };
+
+  std::vector<Result> res(chunks.size());
+
+  std::mutex m;
+  std::condition_variable cv;
+  size_t nextChunk = 0;
+  size_t merged = 0;
+  bool abort = false;
+
+  // the CPU time of the finished workers
+  double workerCpuMs = 0;
+
+  auto work = [&]() {
+    double cpu = threadCpuMs();
+    while (true) {
+      size_t i;
+      {
+        // don't run too far ahead of the merging, to bound memory usage
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&] {
+          return abort || nextChunk == chunks.size() ||
+                 nextChunk < merged + 2 * numThreads;
+        });
+        if (abort || nextChunk == chunks.size()) {
+          workerCpuMs += threadCpuMs() - cpu;
+          return;
+        }
+        i = nextChunk++;
+      }
+
+      Result& r = res[i];
+      CsvParser chunkCsv(*csvp, chunks[i]);
+      chunkWarnings() = &r.warnings;
+
+      try {
+        T t;
+        while ((this->*next)(&chunkCsv, &t, flds)) {
+          r.rows.push_back(std::move(t));
+          r.lines.push_back(chunkCsv.getCurLine());
+        }
+      } catch (...) {
+        r.err = std::current_exception();
+      }
+
+      chunkWarnings() = 0;
+
+      {
+        std::unique_lock<std::mutex> lock(m);
+        r.done = true;
+      }
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < numThreads; i++) threads.push_back(std::thread(work));
+
+  try {
+    for (size_t i = 0; i < chunks.size(); i++) {
+      {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&] { return res[i].done; });
+      }
+
+      Result& r = res[i];
+      size_t w = 0;
+      double insertStart = wallMs();
+
+      for (size_t j = 0; j < r.rows.size(); j++) {
+        // warnings are added in the order the sequential parse would raise
+        // them
+        for (; w < r.warnings.warnings.size() &&
+               r.warnings.warnings[w].line <= r.lines[j];
+             w++)
+          addChunkWarning(*csvp, r.warnings, r.warnings.warnings[w]);
+        add(r.rows[j], r.lines[j]);
+      }
+      for (; w < r.warnings.warnings.size(); w++)
+        addChunkWarning(*csvp, r.warnings, r.warnings.warnings[w]);
+
+      if (tableStats()) tableStats()->insertMs += wallMs() - insertStart;
+
+      if (r.err) std::rethrow_exception(r.err);
+
+      r = Result();
+      csvp->release(chunks[i].begin, chunks[i].end);
+      {
+        std::unique_lock<std::mutex> lock(m);
+        merged = i + 1;
+      }
+      cv.notify_all();
     }
+  } catch (...) {
+    {
+      std::unique_lock<std::mutex> lock(m);
+      abort = true;
+    }
+    cv.notify_all();
+    for (auto& t : threads) t.join();
+    giveThreads(numThreads);
+    throw;
   }
 
-  if (color_string.size() != 6 || chars_processed != 8) {
-    std::stringstream msg;
-    msg << "expected a 6-character hexadecimal color string, found '"
-        << color_string << "' instead.";
-    if (_strict) {
-      throw ParserException(msg.str(), csv.getFieldName(field),
-                            csv.getCurLine(), csv.getReadablePath());
-    } else {
-      if (_warnCb)
-        _warnCb(ParserException(msg.str(), csv.getFieldName(field),
-                                csv.getCurLine(), csv.getReadablePath())
-                    .what());
-      return std::stoul("0x" + def, &chars_processed, 16);
+  for (auto& t : threads) t.join();
+  giveThreads(numThreads);
+  if (tableStats()) tableStats()->cpuMs += workerCpuMs;
+}
+
+// ___________________________________________________________________________
+void Parser::addChunkWarning(const CsvParser& csv,
+                             const ParserWarnings& chunk,
+                             const ParserWarning& w) const {
+  warn(csv, w.fld, w.line, w.code, w.minv, w.maxv,
+       w.code == ParserWarning::INVALID_HEX_COLOR ? chunk.vals.data() + w.val
+                                                  : 0);
+}
+
+// ___________________________________________________________________________
+void Parser::flushWarnings() const {
+  if (_warnCb) {
+    for (const auto& w : _warns.warnings) _warnCb(formatWarning(w));
+
+    for (const auto& f : _warns.fields) {
+      if (f.count <= _maxWarnsPerField) continue;
+      std::stringstream msg;
+      msg << (f.count - _maxWarnsPerField) << " more warnings suppressed";
+      _warnCb(ParserException(msg.str(), f.fieldName, -1, f.fileName).what());
     }
   }
 
-  return ret;
+  _warns = ParserWarnings();
 }
 
 // ____________________________________________________________________________
@@ -1853,15 +3149,16 @@ ServiceDate Parser::getServiceDate(const CsvParser& csv, size_t field,
                             csv.getCurLine(), csv.getReadablePath());
     }
   }
-  const char* val = csv.getTString(field);
-  if (strlen(val) == 0 && !req) return ServiceDate();
+  char buf[16];
+  const char* val = csv.getTString(field, buf, sizeof(buf));
+  if (val[0] == 0 && !req) return ServiceDate();
 
   try {
     uint32_t yyyymmdd = atoi(&val);
     if (*val != 0 || yyyymmdd > 99999999) {
       std::stringstream msg;
       msg << "expected a date in the YYYYMMDD format, found '"
-          << csv.getTString(field) << "' instead.";
+          << csv.getTString(field, buf, sizeof(buf)) << "' instead.";
       throw ParserException(msg.str(), csv.getFieldName(field),
                             csv.getCurLine(), csv.getReadablePath());
     }
@@ -1883,52 +3180,84 @@ ServiceDate Parser::getServiceDate(const CsvParser& csv, size_t field,
 
 // ____________________________________________________________________________
 Time Parser::getTime(const CsvParser& csv, size_t field) const {
-  const char* val = csv.getTString(field);
+  // times are decoded from a copy on the stack
+  char buf[16];
+  const char* val = csv.getTString(field, buf, sizeof(buf));
 
   // TODO(patrick): null value
   if (val[0] == 0) return Time();
 
-  try {
-    uint32_t h = atoi(&val);
-    if (h > 255)
-      throw std::out_of_range(
-          "only non-negative hour-values up to 255 are "
-          "supported.");
-    if (*val != ':') {
-      throw std::invalid_argument("invalid separator");
-    }
-
-    val++;
+  Time t;
+  TIME_STATUS st = decodeTime(val, &t);
+  if (st == TIME_OK) return t;
+
+  std::stringstream msg;
+  msg << "expected a time in HH:MM:SS (or H:MM:SS) format, found '" << val
+      << "' instead. (";
+  switch (st) {
+    case TIME_HOUR_RANGE:
+      msg << "only non-negative hour-values up to 255 are supported.";
+      break;
+    case TIME_INVALID_SEP:
+      msg << "invalid separator";
+      break;
+    case TIME_MINUTE_RANGE:
+      msg << "only non-negative minute-values up to 60 are allowed.";
+      break;
+    default:
+      msg << "only non-negative second-values up to 60 are allowed.";
+  }
+  msg << ")";
+  throw ParserException(msg.str(), csv.getFieldName(field), csv.getCurLine(),
+                        csv.getReadablePath());
+}
+
+// ____________________________________________________________________________
+inline Parser::TIME_STATUS Parser::decodeTime(const char* val, Time* t) {
+  uint32_t h, m, s;
+
+  // fast path for the fixed-width forms HH:MM:SS and H:MM:SS. The checks
+  // are ordered so that no byte after the terminating 0 is read.
+  size_t o = val[1] == ':' ? 0 : 1;
+  if (isDigit(val[0]) && isDigit(val[o]) && val[o + 1] == ':' &&
+      isDigit(val[o + 2]) && isDigit(val[o + 3]) && val[o + 4] == ':' &&
+      isDigit(val[o + 5]) && isDigit(val[o + 6]) && val[o + 7] == 0) {
+    h = (val[o] - '0') + o * 10 * (val[0] - '0');
+    m = (val[o + 2] - '0') * 10 + (val[o + 3] - '0');
+    s = (val[o + 5] - '0') * 10 + (val[o + 6] - '0');
 
-    uint32_t m = atoi(&val);
     // allow values of 60, although standard forbids it
-    if (m > 60)
-      throw std::out_of_range(
-          "only non-negative minute-values up to 60 are "
-          "allowed.");
+    if (m > 60) return TIME_MINUTE_RANGE;
+    if (s > 60) return TIME_SECOND_RANGE;
+
+    *t = Time(h, m % 60, s % 60);
+    return TIME_OK;
+  }
 
-    // allow missing second values, although standard forbids it
-    uint32_t s = 0;
+  // generic path for everything else
+  h = atoi(&val);
+  if (h > 255) return TIME_HOUR_RANGE;
+  if (*val != ':') return TIME_INVALID_SEP;
 
-    if (*val == ':') {
-      val++;
-      s = atoi(&val);
-    }
+  val++;
 
-    // allow values of 60, although standard forbids it
-    if (s > 60)
-      throw std::out_of_range(
-          "only non-negative second-values up to 60 are "
-          "allowed.");
+  m = atoi(&val);
+  // allow values of 60, although standard forbids it
+  if (m > 60) return TIME_MINUTE_RANGE;
 
-    return Time(h, m % 60, s % 60);
-  } catch (const std::exception& e) {
-    std::stringstream msg;
-    msg << "expected a time in HH:MM:SS (or H:MM:SS) format, found '"
-        << csv.getTString(field) << "' instead. (" << e.what() << ")";
-    throw ParserException(msg.str(), csv.getFieldName(field), csv.getCurLine(),
-                          csv.getReadablePath());
+  // allow missing second values, although standard forbids it
+  s = 0;
+
+  if (*val == ':') {
+    val++;
+    s = atoi(&val);
   }
+
+  // allow values of 60, although standard forbids it
+  if (s > 60) return TIME_SECOND_RANGE;
+
+  *t = Time(h, m % 60, s % 60);
+  return TIME_OK;
 }
 
 // ____________________________________________________________________________
@@ -1944,6 +3273,11 @@ gtfs::flat::Route::TYPE Parser::getRouteType(const CsvParser& csv, size_t field,
   return t;
 }
 
+// ___________________________________________________________________________
+inline bool Parser::isDigit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
 // ___________________________________________________________________________
 inline uint32_t Parser::atoi(const char** p) {
   uint32_t x = 0;
@@ -1958,10 +3292,109 @@ inline uint32_t Parser::atoi(const char** p) {
 // ___________________________________________________________________________
 inline std::unique_ptr<CsvParser> Parser::getCsvParser(
     const std::string& file) const {
+  return getCsvParser(file, true);
+}
+
+// ___________________________________________________________________________
+inline std::unique_ptr<CsvParser> Parser::getCsvParser(const std::string& file,
+                                                       bool whole) const {
+  ParserTableStats* stats = tableStats();
+  if (!stats) return openCsvParser(file, whole);
+
+  double start = wallMs();
+
+#ifdef LIBZIP_FOUND
+  size_t compressed = 0;
+  if (_za) {
+    // looked up first, a parser inflating on a background thread uses the
+    // archive handle until it is destroyed
+    zip* za = archive();
+    auto fi = zip_name_locate(za, file.c_str(), ZIP_FL_NOCASE | ZIP_FL_NODIR);
+    zip_stat_t st;
+    zip_stat_init(&st);
+    if (fi >= 0 && zip_stat_index(za, fi, 0, &st) == 0 &&
+        (st.valid & ZIP_STAT_COMP_SIZE))
+      compressed = st.comp_size;
+  }
+#endif
+
+  auto csvp = openCsvParser(file, whole);
+  stats->openMs += wallMs() - start;
+
+  if (!csvp->isGood()) return csvp;
+
 #ifdef LIBZIP_FOUND
-  if (_za)
-    return std::unique_ptr<CsvParser>(
-        new ZipCsvParser(_za, file, _path + "/" + file));
+  if (_za) {
+    stats->compressedBytes = compressed;
+    return csvp;
+  }
 #endif
-  return std::unique_ptr<CsvParser>(new CsvParser(_path + "/" + file));
+
+  struct stat st;
+  if (dynamic_cast<CompressedCsvParser*>(csvp.get()) &&
+      stat(csvp->getReadablePath().c_str(), &st) == 0)
+    stats->compressedBytes = st.st_size;
+
+  return csvp;
+}
+
+// ___________________________________________________________________________
+inline std::unique_ptr<CsvParser> Parser::openCsvParser(const std::string& file,
+                                                        bool whole) const {
+  // skipped tables are treated as missing
+  if (!reads(file)) return std::unique_ptr<CsvParser>(new CsvParser());
+
+#ifdef LIBZIP_FOUND
+  if (_za) {
+    zip* za = archive();
+
+    // members stored without compression are tokenized directly from a
+    // mapping of the archive
+    auto stored = storedMember(za, file);
+    if (stored) {
+      std::unique_ptr<CsvParser> csvp(new CsvParser(
+          _path, stored->offset, stored->size, _path + "/" + file));
+      if (csvp->isGood()) return csvp;
+    }
+
+    size_t size;
+    std::unique_ptr<char[]> data;
+    if ((_prefetch && _prefetch->get(file, &data, &size)) ||
+        (whole && ZipCsvParser::inflateWhole(za, file, &data, &size)))
+      return std::unique_ptr<CsvParser>(
+          new CsvParser(std::move(data), size, _path + "/" + file));
+
+    // missing members take no thread
+    bool exists =
+        zip_name_locate(za, file.c_str(), ZIP_FL_NOCASE | ZIP_FL_NODIR) >= 0;
+    return std::unique_ptr<CsvParser>(new ZipCsvParser(
+        za, file, _path + "/" + file, exists && readThreaded()));
+  }
+#else
+  // only ZIP members are read whole
+  (void)whole;
+#endif
+  if (_tables) {
+    auto t = _tables->find(file);
+    if (t == _tables->end()) return std::unique_ptr<CsvParser>(new CsvParser());
+
+    return std::unique_ptr<CsvParser>(new CsvParser(
+        t->second.data(), t->second.size(), _path + "/" + file));
+  }
+
+  std::unique_ptr<CsvParser> csvp(new CsvParser(_path + "/" + file));
+  if (csvp->isGood()) return csvp;
+
+  // tables compressed on their own
+  for (const auto& suffix : CompressedCsvParser::getSuffixes()) {
+    // missing files take no thread
+    std::string path = _path + "/" + file + suffix;
+    if (access(path.c_str(), R_OK) != 0) continue;
+
+    std::unique_ptr<CsvParser> ccsvp(
+        new CompressedCsvParser(path, readThreaded()));
+    if (ccsvp->isGood()) return ccsvp;
+  }
+
+  return csvp;
 }
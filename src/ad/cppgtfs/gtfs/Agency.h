@@ -6,7 +6,9 @@
 #define AD_CPPGTFS_GTFS_AGENCY_H_
 
 #include <string>
+#include <utility>
 #include "flat/Agency.h"
+#include "StringPool.h"
 
 using std::exception;
 using std::string;
@@ -15,29 +17,31 @@ namespace ad {
 namespace cppgtfs {
 namespace gtfs {
 
-class Agency {
+// TextT is the type of the text fields, std::string, or PoolString for the
+// agencies of a PooledFeed.
+template <typename TextT>
+class AgencyB {
  public:
-  typedef Agency* Ref;
+  typedef AgencyB<TextT>* Ref;
+  typedef TextT Text;
   static std::string getId(Ref r) { return r->getId(); }
 
-  Agency() {}
+  AgencyB() {}
 
-  Agency(const std::string& id, const std::string& name, const std::string& url,
-         const std::string& timezone, const std::string& lang,
-         const std::string& phone, const std::string& fare_url,
-         const std::string& agency_email)
+  AgencyB(const std::string& id, TextT name, TextT url, TextT timezone,
+          TextT lang, TextT phone, TextT fare_url, TextT agency_email)
       : _id(id),
-        _name(name),
-        _url(url),
-        _timezone(timezone),
-        _lang(lang),
-        _phone(phone),
-        _fare_url(fare_url),
-        _agency_email(agency_email) {}
-
-  Agency(const char* id, const char* name, const char* url,
-         const char* timezone, const char* lang, const char* phone,
-         const char* fare_url, const char* agency_email)
+        _name(std::move(name)),
+        _url(std::move(url)),
+        _timezone(std::move(timezone)),
+        _lang(std::move(lang)),
+        _phone(std::move(phone)),
+        _fare_url(std::move(fare_url)),
+        _agency_email(std::move(agency_email)) {}
+
+  AgencyB(const char* id, const char* name, const char* url,
+          const char* timezone, const char* lang, const char* phone,
+          const char* fare_url, const char* agency_email)
       : _id(id),
         _name(name),
         _url(url),
@@ -49,19 +53,19 @@ class Agency {
 
   const std::string& getId() const { return _id; }
 
-  const std::string& getName() const { return _name; }
+  const TextT& getName() const { return _name; }
 
-  const std::string& getUrl() const { return _url; }
+  const TextT& getUrl() const { return _url; }
 
-  const std::string& getTimezone() const { return _timezone; }
+  const TextT& getTimezone() const { return _timezone; }
 
-  const std::string& getLang() const { return _lang; }
+  const TextT& getLang() const { return _lang; }
 
-  const std::string& getPhone() const { return _phone; }
+  const TextT& getPhone() const { return _phone; }
 
-  const std::string& getFareUrl() const { return _fare_url; }
+  const TextT& getFareUrl() const { return _fare_url; }
 
-  const std::string& getAgencyEmail() const { return _agency_email; }
+  const TextT& getAgencyEmail() const { return _agency_email; }
 
   flat::Agency getFlat() const {
     flat::Agency r;
@@ -79,10 +83,13 @@ class Agency {
   // TODO(patrick): implement setters
 
  private:
-  std::string _id, _name, _url, _timezone, _lang, _phone, _fare_url,
-      _agency_email;
+  std::string _id;
+  TextT _name, _url, _timezone, _lang, _phone, _fare_url, _agency_email;
 };
 
+typedef AgencyB<std::string> Agency;
+typedef AgencyB<PoolString> PooledAgency;
+
 }  // namespace gtfs
 }  // namespace cppgtfs
 }  // namespace ad
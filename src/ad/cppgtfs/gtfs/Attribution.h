@@ -27,7 +27,8 @@ class Attribution {
   typedef flat::Attribution::TYPE TYPE;
   Attribution() {}
 
-  Attribution(const std::string& attributionId, Agency* agency, Route* route,
+  Attribution(const std::string& attributionId,
+              typename RouteT::AgencyRef agency, typename RouteT::Ref route,
               TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* trip,
               const std::string& organizationName, TYPE isProducer,
               TYPE isOperator, TYPE isAuthority,
@@ -46,9 +47,9 @@ class Attribution {
         _attributionEmail(attributionEmail),
         _attributionPhone(attributionPhone) {}
 
-  Route* getRoute() const { return _route; }
+  typename RouteT::Ref getRoute() const { return _route; }
 
-  Agency* getAgency() const { return _agency; }
+  typename RouteT::AgencyRef getAgency() const { return _agency; }
 
   TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* getTrip() const {
     return _trip;
@@ -87,8 +88,8 @@ class Attribution {
 
  private:
   std::string _attributionId;
-  Agency* _agency;
-  Route* _route;
+  typename RouteT::AgencyRef _agency;
+  typename RouteT::Ref _route;
   TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* _trip;
   const std::string& _organizationName;
   TYPE _isProducer;
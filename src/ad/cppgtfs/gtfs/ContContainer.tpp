@@ -4,11 +4,11 @@
 
 // ____________________________________________________________________________
 template <typename T>
-T* ContContainer<T>::add(const T& ent) {
+T* ContContainer<T>::add(T ent) {
   if (_final)
     throw std::runtime_error("Can't add to a finalized continuous container.");
   ;
-  _vec.push_back(ent);
+  _vec.push_back(std::move(ent));
   return &_vec.back();
 }
 
@@ -18,6 +18,14 @@ void ContContainer<T>::finalize() {
   auto cmp = ContCompCmp<T>();
   std::sort(_vec.begin(), _vec.end(), cmp);
   _final = true;
+
+  if (!_frozen) return;
+
+  // the vector is not changed anymore, so pointers into it stay valid
+  std::vector<T*> ents;
+  ents.reserve(_vec.size());
+  for (auto& e : _vec) ents.push_back(&e);
+  _index.build(ents);
 }
 
 // ____________________________________________________________________________
@@ -45,6 +53,7 @@ T* ContContainer<T>::get(const std::string& id) {
   if (!_final)
     throw std::runtime_error(
         "Cannot get from an unfinalized continuous container.");
+  if (!_index.empty()) return _index.get(id);
   auto cmp = ContCompCmp2<T>();
   auto i = std::lower_bound(_vec.begin(), _vec.end(), id, cmp);
   if (i == _vec.end()) return 0;
@@ -58,6 +67,7 @@ const T* ContContainer<T>::get(const std::string& id) const {
   if (!_final)
     throw std::runtime_error(
         "Cannot get from an unfinalized continuous container.");
+  if (!_index.empty()) return _index.get(id);
   auto cmp = ContCompCmp2<T>();
   auto i = std::lower_bound(_vec.begin(), _vec.end(), id, cmp);
   if (i == _vec.end()) return 0;
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 namespace ad {
 namespace cppgtfs {
@@ -17,7 +18,7 @@ class Container {
  public:
   Container(){};
   ~Container();
-  T* add(const T& obj);
+  T* add(T obj);
   bool remove(const std::string& id);
   const T* get(const std::string& id) const;
   T* get(const std::string& id);
@@ -25,7 +26,11 @@ class Container {
   const T* getRef(const std::string& id) const { return get(id); }
   T* getRef(const std::string& id) { return get(id); }
   size_t size() const;
-  void finalize() {};
+
+  // Does nothing. The map is needed for iteration, and a FrozenIndex on top
+  // of it would take memory without making lookups faster.
+  void setFrozenIndex(bool frozen) { (void)frozen; }
+  void finalize() {}
 
   typename std::unordered_map<std::string, T*>::const_iterator begin() const;
   typename std::unordered_map<std::string, T*>::iterator begin();
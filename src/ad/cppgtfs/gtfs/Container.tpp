@@ -12,8 +12,8 @@ Container<T>::~Container() {
 
 // ____________________________________________________________________________
 template <typename T>
-T* Container<T>::add(const T& ent) {
-  T* c = new T(ent);
+T* Container<T>::add(T ent) {
+  T* c = new T(std::move(ent));
   if (_map.insert(std::pair<std::string, T*>(T::getId(c), c)).second) return c;
   return 0;
 }
@@ -27,18 +27,16 @@ bool Container<T>::remove(const std::string& id) {
 // ____________________________________________________________________________
 template <typename T>
 T* Container<T>::get(const std::string& id) {
-  if (_map.find(id) != _map.end()) {
-    return _map.find(id)->second;
-  }
+  auto i = _map.find(id);
+  if (i != _map.end()) return i->second;
   return 0;
 }
 
 // ____________________________________________________________________________
 template <typename T>
 const T* Container<T>::get(const std::string& id) const {
-  if (_map.find(id) != _map.end()) {
-    return _map.find(id)->second;
-  }
+  auto i = _map.find(id);
+  if (i != _map.end()) return i->second;
   return 0;
 }
 
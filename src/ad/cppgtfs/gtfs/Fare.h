@@ -57,8 +57,8 @@ class Fare {
   Fare() {}
 
   Fare(const std::string& id, double price, const std::string& currencyType,
-       PAYMENT_METHOD paymentMethod, NUM_TRANSFERS numTransfers, Agency* agency,
-       int64_t dur)
+       PAYMENT_METHOD paymentMethod, NUM_TRANSFERS numTransfers,
+       typename RouteT::AgencyRef agency, int64_t dur)
       : _id(id),
         _price(price),
         _currencyType(currencyType),
@@ -77,7 +77,7 @@ class Fare {
 
   NUM_TRANSFERS getNumTransfers() const { return _numTransfers; }
 
-  Agency* getAgency() const { return _agency; }
+  typename RouteT::AgencyRef getAgency() const { return _agency; }
 
   int64_t getDuration() const { return _duration; }
 
@@ -102,7 +102,7 @@ class Fare {
   std::string _currencyType;
   PAYMENT_METHOD _paymentMethod;
   NUM_TRANSFERS _numTransfers;
-  Agency* _agency;
+  typename RouteT::AgencyRef _agency;
   int64_t _duration;
 
   std::vector<FareRule<RouteT>> _fareRules;
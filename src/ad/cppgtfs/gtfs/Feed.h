@@ -9,7 +9,9 @@
 
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -22,7 +24,9 @@
 #include "Route.h"
 #include "Service.h"
 #include "Shape.h"
+#include "SlabContainer.h"
 #include "Stop.h"
+#include "StringPool.h"
 #include "Transfer.h"
 #include "Trip.h"
 #include "Attribution.h"
@@ -74,7 +78,8 @@ class FeedB {
 
  public:
   FeedB()
-      : _maxLat(std::numeric_limits<double>::lowest()),
+      : _strings(POOLED ? new StringPool() : 0),
+        _maxLat(std::numeric_limits<double>::lowest()),
         _maxLon(std::numeric_limits<double>::lowest()),
         _minLat(std::numeric_limits<double>::max()),
         _minLon(std::numeric_limits<double>::max()) {}
@@ -143,6 +148,15 @@ class FeedB {
   double getMaxLat() const;
   double getMaxLon() const;
 
+  // If set, the containers build a FrozenIndex over their ids once they are
+  // finalized (e.g. by the parser, once a table is read). This pays off for
+  // ContContainer, Container ignores it. See the containers for details.
+  void setFrozenIndex(bool frozen);
+
+  // the pool the text fields of the entities of a PooledFeed are stored in,
+  // or 0 for other feeds
+  StringPool* getStringPool() { return _strings.get(); }
+
   const std::string& getPath() const { return _path; }
   void setPath(const std::string& p) { _path = p; }
 
@@ -161,6 +175,15 @@ class FeedB {
   const AddFlds& getAgencyAddFlds() const { return _agencyAddFields; }
 
  private:
+  // whether the text fields of the entities are PoolStrings
+  static const bool POOLED =
+      std::is_same<typename AgencyT::Text, PoolString>::value ||
+      std::is_same<typename StopT::Text, PoolString>::value;
+
+  // declared first to outlive the entities, and shared by copies of the
+  // feed, as their entities refer to it
+  std::shared_ptr<StringPool> _strings;
+
   Agencies _agencies;
   Stops _stops;
   Routes _routes;
@@ -196,6 +219,21 @@ typedef FeedB<Agency, Route, Stop, Service, StopTime, Shape, Fare, Level,
               ContContainer, ContContainer, ContContainer, ContContainer,
               ContContainer, ContContainer>
     ContFeed;
+typedef FeedB<Agency, Route, Stop, Service, StopTime, Shape, Fare, Level,
+              Pathway, SlabContainer, SlabContainer, SlabContainer,
+              SlabContainer, SlabContainer, SlabContainer, SlabContainer,
+              SlabContainer, SlabContainer>
+    SlabFeed;
+
+// A feed whose agencies, routes, trips, stops and stop times store their
+// text fields (names, descriptions, URLs, headsigns and so on) as handles
+// into a StringPool of the feed, where repeated values are stored once.
+// The entities must not outlive the feed.
+typedef FeedB<PooledAgency, PooledRoute, PooledStop, Service, StopTime, Shape,
+              Fare, Level, PathwayB<PooledStop>, Container, Container,
+              Container, Container, Container, Container, Container, Container,
+              Container>
+    PooledFeed;
 
 #include "Feed.tpp"
 
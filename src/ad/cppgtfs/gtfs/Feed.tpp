@@ -236,3 +236,18 @@ void FEEDB::addAgencyAddFld(const std::string& id, const std::string& name,
                             const std::string& val) {
   _agencyAddFields[name][id] = val;
 }
+
+// ____________________________________________________________________________
+FEEDTPL
+void FEEDB::setFrozenIndex(bool frozen) {
+  _agencies.setFrozenIndex(frozen);
+  _stops.setFrozenIndex(frozen);
+  _routes.setFrozenIndex(frozen);
+  _trips.setFrozenIndex(frozen);
+  _shapes.setFrozenIndex(frozen);
+  _services.setFrozenIndex(frozen);
+  _fares.setFrozenIndex(frozen);
+  _levels.setFrozenIndex(frozen);
+  _pathways.setFrozenIndex(frozen);
+}
+
@@ -0,0 +1,89 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_CPPGTFS_GTFS_FROZENINDEX_H_
+#define AD_CPPGTFS_GTFS_FROZENINDEX_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// A read-only index from the ids of entities to the entities, built with a
+// minimal perfect hash function: each id is hashed to a bucket, and the
+// bucket stores a pilot which places its ids on distinct positions. Each
+// entity is stored with a fingerprint of its id, so a lookup takes a single
+// hash and usually a single id comparison.
+template <typename T>
+class FrozenIndex {
+ public:
+  // Builds the index over ents, which must have distinct ids. Returns false
+  // (and leaves the index empty) if no hash function was found.
+  bool build(const std::vector<T*>& ents);
+
+  void clear();
+  bool empty() const { return _slots.empty(); }
+
+  // Returns the entity with the given id, or 0
+  T* get(const std::string& id) const;
+
+  // the memory used by the index, in bytes
+  size_t memory() const;
+
+ private:
+  struct Slot {
+    uint32_t fingerprint;
+    T* ent;
+  };
+
+  // the average number of ids per bucket
+  static const size_t BUCKET_SIZE = 2;
+
+  std::vector<uint32_t> _pilots;
+  std::vector<Slot> _slots;
+
+  // Ids are placed on slightly more positions than there are slots, which
+  // makes finding pilots for the last buckets much faster. The positions
+  // beyond the slots are remapped to the slots left free.
+  uint32_t _positions = 0;
+  std::vector<uint32_t> _remap;
+
+  static uint64_t hash(const std::string& id);
+  static uint64_t mix(uint64_t h);
+
+  // maps x to [0, n)
+  static uint32_t range(uint32_t x, size_t n) {
+    return (static_cast<uint64_t>(x) * n) >> 32;
+  }
+
+  uint32_t bucket(uint64_t h) const {
+    return range(static_cast<uint32_t>(h), _pilots.size());
+  }
+
+  // the position of an id with hash h in a bucket with the given pilot,
+  // which is hashed once for all ids of the bucket
+  uint32_t position(uint64_t h, uint64_t pilotHash) const {
+    return range((h ^ pilotHash) >> 32, _positions);
+  }
+  static uint64_t pilotHash(uint32_t pilot) {
+    return mix(pilot * 0x9E3779B97F4A7C15ull + 1);
+  }
+
+  // the fingerprint of an id with hash h, independent of its position
+  static uint32_t fingerprint(uint64_t h) {
+    return static_cast<uint32_t>(mix(h));
+  }
+};
+
+#include "FrozenIndex.tpp"
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_FROZENINDEX_H_
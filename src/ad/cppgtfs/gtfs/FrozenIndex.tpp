@@ -0,0 +1,146 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// ____________________________________________________________________________
+template <typename T>
+const size_t FrozenIndex<T>::BUCKET_SIZE;
+
+// ____________________________________________________________________________
+template <typename T>
+uint64_t FrozenIndex<T>::mix(uint64_t h) {
+  // the finalizer of MurmurHash3
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+uint64_t FrozenIndex<T>::hash(const std::string& id) {
+  // FNV-1a
+  uint64_t h = 14695981039346656037ull;
+  for (char c : id) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ull;
+  }
+  return mix(h);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void FrozenIndex<T>::clear() {
+  if (empty()) return;
+  std::vector<uint32_t>().swap(_pilots);
+  std::vector<Slot>().swap(_slots);
+  std::vector<uint32_t>().swap(_remap);
+  _positions = 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool FrozenIndex<T>::build(const std::vector<T*>& ents) {
+  clear();
+  size_t n = ents.size();
+  if (n == 0 || n > UINT32_MAX / 2) return false;
+
+  _pilots.assign(n / BUCKET_SIZE + 1, 0);
+  _positions = n + n / 32 + 1;
+
+  std::vector<uint64_t> hashes(n);
+  for (size_t i = 0; i < n; i++) hashes[i] = hash(ents[i]->getId());
+
+  // the entities of each bucket, sorted by bucket
+  std::vector<uint32_t> start(_pilots.size() + 1, 0);
+  for (size_t i = 0; i < n; i++) start[bucket(hashes[i]) + 1]++;
+  for (size_t b = 0; b < _pilots.size(); b++) start[b + 1] += start[b];
+  std::vector<uint32_t> members(n);
+  std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+  for (size_t i = 0; i < n; i++) members[fill[bucket(hashes[i])]++] = i;
+
+  // large buckets are placed first, while most positions are still free
+  size_t maxSize = 0;
+  for (size_t b = 0; b < _pilots.size(); b++)
+    maxSize = std::max<size_t>(maxSize, start[b + 1] - start[b]);
+  std::vector<std::vector<uint32_t>> bySize(maxSize + 1);
+  for (size_t b = 0; b < _pilots.size(); b++)
+    bySize[start[b + 1] - start[b]].push_back(b);
+
+  // ids with the same hash never find a pilot
+  const uint32_t maxPilot = 1 << 24;
+
+  std::vector<uint8_t> taken(_positions, 0);
+  std::vector<uint32_t> posOf(n);
+  std::vector<uint32_t> pos;
+
+  for (size_t size = maxSize; size > 0; size--) {
+    for (uint32_t b : bySize[size]) {
+      uint32_t pilot = 0;
+      for (;; pilot++) {
+        if (pilot == maxPilot) {
+          clear();
+          return false;
+        }
+
+        pos.clear();
+        bool ok = true;
+        uint64_t ph = pilotHash(pilot);
+        for (uint32_t i = start[b]; ok && i < start[b + 1]; i++) {
+          uint32_t p = position(hashes[members[i]], ph);
+          ok = !taken[p];
+          for (uint32_t q : pos) ok = ok && q != p;
+          pos.push_back(p);
+        }
+        if (ok) break;
+      }
+
+      _pilots[b] = pilot;
+      for (size_t i = 0; i < pos.size(); i++) {
+        taken[pos[i]] = 1;
+        posOf[members[start[b] + i]] = pos[i];
+      }
+    }
+  }
+
+  // the positions beyond n take the free slots in order
+  _remap.assign(_positions - n, 0);
+  size_t freeSlot = 0;
+  for (size_t p = n; p < _positions; p++) {
+    if (!taken[p]) continue;
+    while (taken[freeSlot]) freeSlot++;
+    _remap[p - n] = freeSlot++;
+  }
+
+  _slots.resize(n);
+  for (size_t e = 0; e < n; e++) {
+    uint32_t p = posOf[e] < n ? posOf[e] : _remap[posOf[e] - n];
+    _slots[p] = Slot{fingerprint(hashes[e]), ents[e]};
+  }
+
+  return true;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* FrozenIndex<T>::get(const std::string& id) const {
+  if (_slots.empty()) return 0;
+  uint64_t h = hash(id);
+  uint32_t p = position(h, pilotHash(_pilots[bucket(h)]));
+  if (p >= _slots.size()) p = _remap[p - _slots.size()];
+
+  const Slot& s = _slots[p];
+  if (s.fingerprint != fingerprint(h)) return 0;
+  if (s.ent->getId() != id) return 0;
+  return s.ent;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+size_t FrozenIndex<T>::memory() const {
+  return _pilots.capacity() * sizeof(uint32_t) +
+         _slots.capacity() * sizeof(Slot) +
+         _remap.capacity() * sizeof(uint32_t);
+}
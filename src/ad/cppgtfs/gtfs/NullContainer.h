@@ -18,6 +18,7 @@ class NullContainer {
   std::string add(const T& obj) const {return obj.getId();}
   T* get(const std::string&) const {return 0;}
   std::string getRef(const std::string& id) const {return id;}
+  void setFrozenIndex(bool) {}
   void finalize() {};
 };
 
@@ -19,18 +19,20 @@ namespace ad {
 namespace cppgtfs {
 namespace gtfs {
 
-class Pathway {
+template <typename StopT>
+class PathwayB {
  public:
-  typedef Pathway* Ref;
+  typedef PathwayB<StopT>* Ref;
   static std::string getId(Ref r) { return r->getId(); }
 
-  Pathway() {}
+  PathwayB() {}
 
-  Pathway(const std::string& id, Stop* from_stop_id, Stop* to_stop_id,
-          uint8_t pathway_mode, bool is_bidirectional, double length,
-          int64_t traversal_time, int64_t stair_count, double max_slope,
-          double min_width, const std::string& signposted_as,
-          const std::string& reversed_signposted_as)
+  PathwayB(const std::string& id, typename StopT::Ref from_stop_id,
+           typename StopT::Ref to_stop_id, uint8_t pathway_mode,
+           bool is_bidirectional, double length, int64_t traversal_time,
+           int64_t stair_count, double max_slope, double min_width,
+           const std::string& signposted_as,
+           const std::string& reversed_signposted_as)
       : _id(id),
         _from_stop_id(from_stop_id),
         _to_stop_id(to_stop_id),
@@ -67,8 +69,8 @@ class Pathway {
 
  private:
   std::string _id;
-  Stop* _from_stop_id;
-  Stop* _to_stop_id;
+  typename StopT::Ref _from_stop_id;
+  typename StopT::Ref _to_stop_id;
   uint8_t _pathway_mode;
   bool _is_bidirectional;
   double _length;
@@ -80,6 +82,8 @@ class Pathway {
   std::string _reversed_signposted_as;
 };
 
+typedef PathwayB<Stop> Pathway;
+
 }  // namespace gtfs
 }  // namespace cppgtfs
 }  // namespace ad
@@ -29,24 +29,26 @@ template <typename AgencyT>
 class RouteB {
  public:
   typedef RouteB<AgencyT>* Ref;
+  typedef typename AgencyT::Ref AgencyRef;
+  // the type of the text fields, the one of the agencies
+  typedef typename AgencyT::Text Text;
   static std::string getId(Ref r) { return r->getId(); }
 
   typedef flat::Route::TYPE TYPE;
 
   RouteB() {}
 
-  RouteB(const string& id, typename AgencyT::Ref agency,
-         const string& short_name, const string& long_name, const string& desc,
-         flat::Route::TYPE type, const string& url, uint32_t color,
-         uint32_t text_color, int64_t sort_order, uint8_t continuous_pickup,
-         uint8_t continuous_drop_off)
+  RouteB(const string& id, typename AgencyT::Ref agency, Text short_name,
+         Text long_name, Text desc, flat::Route::TYPE type, Text url,
+         uint32_t color, uint32_t text_color, int64_t sort_order,
+         uint8_t continuous_pickup, uint8_t continuous_drop_off)
       : _id(id),
         _agency(agency),
-        _short_name(short_name),
-        _long_name(long_name),
-        _desc(desc),
+        _short_name(std::move(short_name)),
+        _long_name(std::move(long_name)),
+        _desc(std::move(desc)),
         _type(type),
-        _url(url),
+        _url(std::move(url)),
         _color(color),
         _text_color(text_color),
         _sort_order(sort_order),
@@ -59,15 +61,15 @@ class RouteB {
 
   typename AgencyT::Ref getAgency() { return _agency; }
 
-  const std::string& getShortName() const { return _short_name; }
+  const Text& getShortName() const { return _short_name; }
 
-  const std::string& getLongName() const { return _long_name; }
+  const Text& getLongName() const { return _long_name; }
 
-  const std::string& getDesc() const { return _desc; }
+  const Text& getDesc() const { return _desc; }
 
   flat::Route::TYPE getType() const { return _type; }
 
-  const std::string& getUrl() const { return _url; }
+  const Text& getUrl() const { return _url; }
 
   uint32_t getColor() const { return _color; }
 
@@ -110,11 +112,11 @@ class RouteB {
  private:
   string _id;
   typename AgencyT::Ref _agency;
-  string _short_name;
-  string _long_name;
-  string _desc;
+  Text _short_name;
+  Text _long_name;
+  Text _desc;
   flat::Route::TYPE _type;
-  string _url;
+  Text _url;
   uint32_t _color;
   uint32_t _text_color;
   int64_t _sort_order;
@@ -123,6 +125,7 @@ class RouteB {
 };
 
 typedef RouteB<Agency> Route;
+typedef RouteB<PooledAgency> PooledRoute;
 
 }  // namespace gtfs
 }  // namespace cppgtfs
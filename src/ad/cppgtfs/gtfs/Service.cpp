@@ -9,6 +9,33 @@
 using ad::cppgtfs::gtfs::Service;
 using ad::cppgtfs::gtfs::ServiceDate;
 
+namespace {
+// _____________________________________________________________________________
+int64_t toDayNum(const ServiceDate& d) {
+  // days since 1970-01-01, without going through mktime()
+  int64_t y = d.getYear() - (d.getMonth() <= 2);
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  int64_t yoe = y - era * 400;
+  int64_t m = d.getMonth();
+  int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d.getDay() - 1;
+  int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+// _____________________________________________________________________________
+ServiceDate fromDayNum(int64_t z) {
+  z += 719468;
+  int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  int64_t doe = z - era * 146097;
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t mp = (5 * doy + 2) / 153;
+  int64_t d = doy - (153 * mp + 2) / 5 + 1;
+  int64_t m = mp + (mp < 10 ? 3 : -9);
+  return ServiceDate(d, m, yoe + era * 400 + (m <= 2));
+}
+}  // namespace
+
 // _____________________________________________________________________________
 Service::Service(const std::string& id)
     : _id(id),
@@ -46,6 +73,29 @@ bool Service::isActiveOn(const ServiceDate& d) const {
          getExceptionOn(d) == EXCEPTION_TYPE::SERVICE_ADDED;
 }
 
+// _____________________________________________________________________________
+bool Service::isActiveBetween(const ServiceDate& from,
+                              const ServiceDate& to) const {
+  for (auto ex = _exceptions.lower_bound(from);
+       ex != _exceptions.end() && !(ex->first > to); ++ex) {
+    if (ex->second == EXCEPTION_TYPE::SERVICE_ADDED) return true;
+  }
+
+  if (!hasServiceDays() || _serviceDays == SERVICE_DAY::NEVER) return false;
+
+  int64_t first = toDayNum(from > _begin ? from : _begin);
+  int64_t last = toDayNum(to < _end ? to : _end);
+
+  for (int64_t d = first; d <= last; d++) {
+    // 1970-01-01 was a thursday, the days are counted from monday
+    if (!(_serviceDays & (1 << (((d % 7) + 10) % 7)))) continue;
+    if (getExceptionOn(fromDayNum(d)) != EXCEPTION_TYPE::SERVICE_REMOVED)
+      return true;
+  }
+
+  return false;
+}
+
 // _____________________________________________________________________________
 const ServiceDate& Service::getBeginDate() const {
   return _begin;
@@ -40,6 +40,9 @@ class Service {
 
   bool isActiveOn(const ServiceDate& d) const;
 
+  // whether the service is active on at least one day in [from, to]
+  bool isActiveBetween(const ServiceDate& from, const ServiceDate& to) const;
+
   static SERVICE_DAY getServiceDay(const ServiceDate& d);
   uint8_t getServiceDates() const;
 
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <vector>
@@ -48,16 +49,27 @@ class Shape {
   const ShapePoints& getPoints() const { return _shapePoints; }
 
   bool addPoint(const ShapePoint& p) {
-    for (size_t i = 0; i < _shapePoints.size(); i++) {
-      if (_shapePoints[i].seq == p.seq) return false;
+    // points are usually added in order
+    if (_shapePoints.empty() || _shapePoints.back().seq < p.seq) {
+      _shapePoints.push_back(p);
+      return true;
     }
-    _shapePoints.reserve(_shapePoints.size() + 1);
-    _shapePoints.push_back(p);
+
     auto cmp = ShapePointCompare();
-    std::sort(_shapePoints.begin(), _shapePoints.end(), cmp);
+    auto i = std::lower_bound(_shapePoints.begin(), _shapePoints.end(), p, cmp);
+    if (i != _shapePoints.end() && i->seq == p.seq) return false;
+    _shapePoints.insert(i, p);
     return true;
   }
 
+  // Appends p without checking its sequence number. If points were not
+  // appended in order, sortPoints() has to be called afterwards.
+  void appendPoint(const ShapePoint& p) { _shapePoints.push_back(p); }
+
+  void sortPoints() {
+    std::sort(_shapePoints.begin(), _shapePoints.end(), ShapePointCompare());
+  }
+
  private:
   string _id;
   ShapePoints _shapePoints;
@@ -0,0 +1,157 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_CPPGTFS_GTFS_SLABCONTAINER_H_
+#define AD_CPPGTFS_GTFS_SLABCONTAINER_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FrozenIndex.h"
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Iterates over the entities of a SlabContainer in the order they were added.
+// Like the iterators of Container, it yields pairs of an id and an entity,
+// but by value, with the id referring to the one of the entity. As there is
+// no pair to refer to, it is only an input iterator.
+template <typename T>
+class SlabContainerIt {
+ public:
+  typedef std::input_iterator_tag iterator_category;
+  typedef std::pair<const std::string&, T*> value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef value_type reference;
+
+  // holds the pair operator->() points to
+  class pointer {
+   public:
+    explicit pointer(const value_type& v) : _v(v) {}
+    const value_type* operator->() const { return &_v; }
+
+   private:
+    value_type _v;
+  };
+
+  SlabContainerIt(T* const* cur, T* const* end) : _cur(cur), _end(end) {
+    skip();
+  }
+
+  reference operator*() const { return value_type((*_cur)->getId(), *_cur); }
+  pointer operator->() const { return pointer(**this); }
+
+  SlabContainerIt& operator++() {
+    ++_cur;
+    skip();
+    return *this;
+  }
+  SlabContainerIt operator++(int) {
+    SlabContainerIt ret = *this;
+    ++*this;
+    return ret;
+  }
+
+  bool operator==(const SlabContainerIt& o) const { return _cur == o._cur; }
+  bool operator!=(const SlabContainerIt& o) const { return _cur != o._cur; }
+
+ private:
+  T* const* _cur;
+  T* const* _end;
+
+  // skips removed entities
+  void skip() {
+    while (_cur != _end && !*_cur) ++_cur;
+  }
+};
+
+// A container which stores its entities in large slabs instead of allocating
+// each of them on its own, and frees them slab by slab. Entities never move,
+// so pointers to them stay valid. Ids are looked up in a flat table with open
+// addressing.
+template <typename T>
+class SlabContainer {
+ public:
+  typedef SlabContainerIt<T> iterator;
+  typedef SlabContainerIt<T> const_iterator;
+
+  SlabContainer() : _slots(16, EMPTY) {}
+  SlabContainer(const SlabContainer&) = delete;
+  SlabContainer& operator=(const SlabContainer&) = delete;
+
+  T* add(T obj);
+
+  // Removes the entity with the given id. Its memory is only freed with the
+  // container.
+  bool remove(const std::string& id);
+
+  const T* get(const std::string& id) const;
+  T* get(const std::string& id);
+  bool has(const std::string& id) const;
+  const T* getRef(const std::string& id) const { return get(id); }
+  T* getRef(const std::string& id) { return get(id); }
+  size_t size() const { return _size; }
+
+  // If set, finalize() replaces the table of ids by a FrozenIndex, until the
+  // container is changed again. Lookups of ids in the container then take
+  // about as long as with the table, lookups of other ids can take longer.
+  void setFrozenIndex(bool frozen) { _frozen = frozen; }
+  void finalize();
+
+  const_iterator begin() const;
+  iterator begin();
+
+  const_iterator end() const;
+  iterator end();
+
+ private:
+  static const uint32_t EMPTY = UINT32_MAX;
+  static const uint32_t REMOVED = UINT32_MAX - 1;
+
+  // the capacity of the first slab, and the maximum capacity of a slab
+  static const size_t MIN_SLAB = 32;
+  static const size_t MAX_SLAB = 1 << 16;
+
+  // the slabs, each of them filled up to its reserved capacity
+  std::vector<std::vector<T>> _slabs;
+
+  // the entities in the order they were added, 0 if removed, and the hashes
+  // of their ids
+  std::vector<T*> _ents;
+  std::vector<uint32_t> _hashes;
+
+  // the slots hold the positions of the entities in _ents
+  std::vector<uint32_t> _slots;
+  size_t _usedSlots = 0;
+  size_t _size = 0;
+
+  bool _frozen = false;
+  FrozenIndex<T> _index;
+
+  static uint32_t hash(const std::string& id);
+
+  // returns the slot of id with hash h, or the size of _slots if it has none
+  size_t findSlot(const std::string& id, uint32_t h) const;
+  void grow();
+
+  // fills a new table of n slots with the entities
+  void rehash(size_t n);
+
+  // replaces the FrozenIndex by a table again
+  void thaw();
+};
+
+#include "SlabContainer.tpp"
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_SLABCONTAINER_H_
@@ -0,0 +1,193 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// ____________________________________________________________________________
+template <typename T>
+const uint32_t SlabContainer<T>::EMPTY;
+
+// ____________________________________________________________________________
+template <typename T>
+const uint32_t SlabContainer<T>::REMOVED;
+
+// ____________________________________________________________________________
+template <typename T>
+const size_t SlabContainer<T>::MIN_SLAB;
+
+// ____________________________________________________________________________
+template <typename T>
+const size_t SlabContainer<T>::MAX_SLAB;
+
+// ____________________________________________________________________________
+template <typename T>
+uint32_t SlabContainer<T>::hash(const std::string& id) {
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  for (char c : id) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+size_t SlabContainer<T>::findSlot(const std::string& id, uint32_t h) const {
+  size_t mask = _slots.size() - 1;
+
+  for (size_t i = h & mask;; i = (i + 1) & mask) {
+    uint32_t e = _slots[i];
+    if (e == EMPTY) return _slots.size();
+    if (e == REMOVED || _hashes[e] != h) continue;
+    if (_ents[e]->getId() == id) return i;
+  }
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* SlabContainer<T>::add(T ent) {
+  thaw();
+  uint32_t h = hash(ent.getId());
+  if (findSlot(ent.getId(), h) != _slots.size()) return 0;
+
+  // keep the table at most half full
+  if (2 * (_usedSlots + 1) > _slots.size()) grow();
+
+  if (_slabs.empty() || _slabs.back().size() == _slabs.back().capacity()) {
+    size_t cap = _slabs.empty()
+                     ? MIN_SLAB
+                     : std::min(_slabs.back().capacity() * 2, MAX_SLAB);
+    _slabs.push_back(std::vector<T>());
+    _slabs.back().reserve(cap);
+  }
+
+  // never exceeds the reserved capacity, so the slab is not moved
+  _slabs.back().push_back(std::move(ent));
+  T* c = &_slabs.back().back();
+
+  size_t mask = _slots.size() - 1;
+  size_t i = h & mask;
+  while (_slots[i] != EMPTY) i = (i + 1) & mask;
+
+  _slots[i] = _ents.size();
+  _usedSlots++;
+  _ents.push_back(c);
+  _hashes.push_back(h);
+  _size++;
+
+  return c;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool SlabContainer<T>::remove(const std::string& id) {
+  thaw();
+  size_t i = findSlot(id, hash(id));
+  if (i == _slots.size()) return false;
+
+  _ents[_slots[i]] = 0;
+  _slots[i] = REMOVED;
+  _size--;
+  return true;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void SlabContainer<T>::grow() {
+  // removed entities are dropped from the table, which only grows if the
+  // remaining ones need it
+  size_t n = _slots.size();
+  if (2 * (_size + 1) > n) n *= 2;
+  rehash(n);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void SlabContainer<T>::rehash(size_t n) {
+  _slots.assign(n, EMPTY);
+  size_t mask = n - 1;
+
+  for (size_t e = 0; e < _ents.size(); e++) {
+    if (!_ents[e]) continue;
+    size_t i = _hashes[e] & mask;
+    while (_slots[i] != EMPTY) i = (i + 1) & mask;
+    _slots[i] = e;
+  }
+
+  _usedSlots = _size;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* SlabContainer<T>::get(const std::string& id) {
+  if (!_index.empty()) return _index.get(id);
+  size_t i = findSlot(id, hash(id));
+  if (i == _slots.size()) return 0;
+  return _ents[_slots[i]];
+}
+
+// ____________________________________________________________________________
+template <typename T>
+const T* SlabContainer<T>::get(const std::string& id) const {
+  if (!_index.empty()) return _index.get(id);
+  size_t i = findSlot(id, hash(id));
+  if (i == _slots.size()) return 0;
+  return _ents[_slots[i]];
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool SlabContainer<T>::has(const std::string& id) const {
+  return get(id) != 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void SlabContainer<T>::finalize() {
+  if (!_frozen || !_index.empty()) return;
+
+  std::vector<T*> ents;
+  ents.reserve(_size);
+  for (T* e : _ents)
+    if (e) ents.push_back(e);
+  if (!_index.build(ents)) return;
+
+  std::vector<uint32_t>().swap(_slots);
+  _usedSlots = 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void SlabContainer<T>::thaw() {
+  if (_index.empty()) return;
+  _index.clear();
+
+  size_t n = 16;
+  while (2 * (_size + 1) > n) n *= 2;
+  rehash(n);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename SlabContainer<T>::const_iterator SlabContainer<T>::begin() const {
+  return const_iterator(_ents.data(), _ents.data() + _ents.size());
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename SlabContainer<T>::iterator SlabContainer<T>::begin() {
+  return iterator(_ents.data(), _ents.data() + _ents.size());
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename SlabContainer<T>::const_iterator SlabContainer<T>::end() const {
+  return const_iterator(_ents.data() + _ents.size(),
+                        _ents.data() + _ents.size());
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename SlabContainer<T>::iterator SlabContainer<T>::end() {
+  return iterator(_ents.data() + _ents.size(), _ents.data() + _ents.size());
+}
@@ -8,8 +8,10 @@
 #include <stdint.h>
 #include <cassert>
 #include <string>
+#include <utility>
 #include "flat/Stop.h"
 #include "Level.h"
+#include "StringPool.h"
 
 using std::exception;
 using std::string;
@@ -18,29 +20,33 @@ namespace ad {
 namespace cppgtfs {
 namespace gtfs {
 
-class Stop {
+// TextT is the type of the text fields, std::string, or PoolString for the
+// stops of a PooledFeed.
+template <typename TextT>
+class StopB {
  public:
-  typedef Stop* Ref;
+  typedef StopB<TextT>* Ref;
+  typedef TextT Text;
   static std::string getId(Ref r) { return r->getId(); }
   typedef flat::Stop::LOCATION_TYPE LOCATION_TYPE;
   typedef flat::Stop::WHEELCHAIR_BOARDING WHEELCHAIR_BOARDING;
 
-  Stop() {}
+  StopB() {}
 
-  Stop(const string& id, const string& code, const string& name,
-       const string& desc, float lat, float lng, string zone_id,
-       const string& stop_url, flat::Stop::LOCATION_TYPE location_type,
-       Stop* parent_station, const string& stop_timezone,
-       flat::Stop::WHEELCHAIR_BOARDING wheelchair_boarding,
-       const std::string& platform_code, Level* level)
+  StopB(const string& id, TextT code, TextT name, TextT desc, float lat,
+        float lng, TextT zone_id, TextT stop_url,
+        flat::Stop::LOCATION_TYPE location_type, Ref parent_station,
+        TextT stop_timezone,
+        flat::Stop::WHEELCHAIR_BOARDING wheelchair_boarding,
+        TextT platform_code, Level* level)
       : _id(id),
-        _code(code),
-        _name(name),
-        _desc(desc),
-        _zone_id(zone_id),
-        _stop_url(stop_url),
-        _stop_timezone(stop_timezone),
-        _platform_code(platform_code),
+        _code(std::move(code)),
+        _name(std::move(name)),
+        _desc(std::move(desc)),
+        _zone_id(std::move(zone_id)),
+        _stop_url(std::move(stop_url)),
+        _stop_timezone(std::move(stop_timezone)),
+        _platform_code(std::move(platform_code)),
         _parent_station(parent_station),
         _lat(lat),
         _lng(lng),
@@ -50,31 +56,31 @@ class Stop {
 
   const std::string& getId() const { return _id; }
 
-  const std::string& getCode() const { return _code; }
+  const TextT& getCode() const { return _code; }
 
-  const std::string& getName() const { return _name; }
+  const TextT& getName() const { return _name; }
 
-  const std::string& getPlatformCode() const { return _platform_code; }
+  const TextT& getPlatformCode() const { return _platform_code; }
 
-  const std::string& getDesc() const { return _desc; }
+  const TextT& getDesc() const { return _desc; }
 
   float getLat() const { return _lat; }
 
   float getLng() const { return _lng; }
 
-  const std::string& getZoneId() const { return _zone_id; }
+  const TextT& getZoneId() const { return _zone_id; }
 
-  const std::string& getStopUrl() const { return _stop_url; }
+  const TextT& getStopUrl() const { return _stop_url; }
 
   flat::Stop::LOCATION_TYPE getLocationType() const { return _location_type; }
 
-  const Stop* getParentStation() const { return _parent_station; }
+  const StopB* getParentStation() const { return _parent_station; }
 
-  Stop* getParentStation() { return _parent_station; }
+  Ref getParentStation() { return _parent_station; }
 
-  void setParentStation(Stop* p) { _parent_station = p; }
+  void setParentStation(Ref p) { _parent_station = p; }
 
-  const std::string& getStopTimezone() const { return _stop_timezone; }
+  const TextT& getStopTimezone() const { return _stop_timezone; }
 
   flat::Stop::WHEELCHAIR_BOARDING getWheelchairBoarding() const {
     return _wheelchair_boarding;
@@ -104,15 +110,19 @@ class Stop {
   // TODO(patrick): implement setters
 
  private:
-  string _id, _code, _name, _desc, _zone_id, _stop_url, _stop_timezone,
+  string _id;
+  TextT _code, _name, _desc, _zone_id, _stop_url, _stop_timezone,
       _platform_code;
-  Stop* _parent_station;
+  Ref _parent_station;
   float _lat, _lng;
   flat::Stop::WHEELCHAIR_BOARDING _wheelchair_boarding;
   flat::Stop::LOCATION_TYPE _location_type;
   Level* _level;
 };
 
+typedef StopB<std::string> Stop;
+typedef StopB<PoolString> PooledStop;
+
 }  // namespace gtfs
 }  // namespace cppgtfs
 }  // namespace ad
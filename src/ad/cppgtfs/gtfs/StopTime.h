@@ -10,6 +10,7 @@
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Stop.h"
@@ -28,16 +29,21 @@ template <typename StopT>
 class StopTime {
  public:
   typedef flat::StopTime::PU_DO_TYPE PU_DO_TYPE;
+  typedef typename StopT::Ref StopRef;
+  // the type of the headsign, the one of the text fields of the stops
+  typedef typename StopT::Text Text;
+
+  StopTime() {}
 
   StopTime(const Time& at, const Time& dt, typename StopT::Ref s, uint32_t seq,
-           const std::string& hs, PU_DO_TYPE put, PU_DO_TYPE dot,
+           Text hs, PU_DO_TYPE put, PU_DO_TYPE dot,
            float distTrav, bool isTp, uint8_t continuousDropOff,
            uint8_t continuousPickup)
       : _at(at),
         _dt(dt),
         _s(s),
         _sequence(seq),
-        _headsign(hs),
+        _headsign(std::move(hs)),
         _pickupType(put),
         _dropOffType(dot),
         _isTimepoint(isTp),
@@ -50,7 +56,8 @@ class StopTime {
 
   const typename StopT::Ref getStop() const { return _s; }
   typename StopT::Ref getStop() { return _s; }
-  const std::string& getHeadsign() const { return _headsign; }
+  const Text& getHeadsign() const { return _headsign; }
+  const Text& getHeadsignText() const { return _headsign; }
 
   PU_DO_TYPE getPickupType() const {
     return static_cast<PU_DO_TYPE>(_pickupType);
@@ -75,7 +82,7 @@ class StopTime {
 
   typename StopT::Ref _s;
   uint32_t _sequence;
-  std::string _headsign;
+  Text _headsign;
   uint8_t _pickupType : 2;
   uint8_t _dropOffType : 2;
   bool _isTimepoint : 1;
@@ -0,0 +1,418 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_CPPGTFS_GTFS_STOPTIMELIST_H_
+#define AD_CPPGTFS_GTFS_STOPTIMELIST_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flat/StopTime.h"
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+template <typename StopTimeT>
+class StopTimeList;
+
+template <typename ListT, typename RefT>
+class StopTimeListIt;
+
+// The i-th stop time of a StopTimeList, which is what the iterators and
+// operator[] of a non-const list return, like std::vector<bool>::reference.
+// Its getters read the fields from the list, setting its distance sets it in
+// the list, and assigning a stop time to it replaces the stop time in the
+// list. Copies refer to the same position, so std::swap() does not work on
+// it, use std::iter_swap() or swap() without std:: instead. It is
+// returned const, so that auto& binds to it, which is why its setters are
+// const, too.
+template <typename StopTimeT>
+class StopTimeRef {
+ public:
+  typedef typename StopTimeT::PU_DO_TYPE PU_DO_TYPE;
+  typedef typename StopTimeT::StopRef StopRef;
+
+  StopTimeRef(const StopTimeRef& o) = default;
+
+  const StopTimeRef& operator=(const StopTimeRef& o) const {
+    return *this = static_cast<StopTimeT>(o);
+  }
+  const StopTimeRef& operator=(const StopTimeT& st) const {
+    _list->set(_i, st, st.getHeadsignText());
+    return *this;
+  }
+
+  // the stop time, assembled from the list
+  operator StopTimeT() const { return _list->get(_i); }
+
+  // swaps the stop times, not the positions they refer to
+  friend void swap(const StopTimeRef& a, const StopTimeRef& b) {
+    StopTimeT tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  flat::Time getArrivalTime() const { return _list->getArrivalTime(_i); }
+  flat::Time getDepartureTime() const { return _list->getDepartureTime(_i); }
+  StopRef getStop() const { return _list->getStop(_i); }
+  const typename StopTimeT::Text& getHeadsign() const {
+    return getHeadsignText();
+  }
+  const typename StopTimeT::Text& getHeadsignText() const {
+    return _list->getHeadsignText(_i);
+  }
+  PU_DO_TYPE getPickupType() const { return _list->getPickupType(_i); }
+  PU_DO_TYPE getDropOffType() const { return _list->getDropOffType(_i); }
+  uint8_t getContinuousDropOff() const {
+    return _list->getContinuous(_i) >> 2;
+  }
+  uint8_t getContinuousPickup() const { return _list->getContinuous(_i) & 3; }
+  float getShapeDistanceTravelled() const {
+    return _list->getShapeDistanceTravelled(_i);
+  }
+  void setShapeDistanceTravelled(float d) const {
+    _list->setShapeDistanceTravelled(_i, d);
+  }
+  bool isTimepoint() const { return _list->isTimepoint(_i); }
+  uint16_t getSeq() const { return _list->getSeq(_i); }
+
+ private:
+  friend class StopTimeList<StopTimeT>;
+
+  StopTimeRef(StopTimeList<StopTimeT>* list, size_t i) : _list(list), _i(i) {}
+
+  StopTimeList<StopTimeT>* _list;
+  size_t _i;
+};
+
+// Iterates over the stop times of a StopTimeList, ListT, which it returns by
+// value: as StopTimeRefs for a non-const list, and assembled for a const one.
+// Like the iterators of std::vector<bool>, it is tagged as a random-access
+// iterator although its reference is not a real reference, so std::prev(),
+// std::distance() and std::lower_bound() take constant or logarithmic time.
+template <typename ListT, typename RefT>
+class StopTimeListIt {
+ public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef typename ListT::value_type value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const RefT reference;
+
+  // what operator-> returns, it holds the stop time
+  class pointer {
+   public:
+    const RefT* operator->() const { return &_ref; }
+
+   private:
+    friend class StopTimeListIt;
+    explicit pointer(const RefT& ref) : _ref(ref) {}
+    RefT _ref;
+  };
+
+  StopTimeListIt() : _list(0), _i(0) {}
+  StopTimeListIt(ListT* list, size_t i) : _list(list), _i(i) {}
+
+  // an iterator converts to a const_iterator
+  template <typename L, typename R>
+  StopTimeListIt(
+      const StopTimeListIt<L, R>& o,
+      typename std::enable_if<std::is_convertible<L*, ListT*>::value>::type* =
+          0)
+      : _list(o._list), _i(o._i) {}
+
+  reference operator*() const { return (*_list)[_i]; }
+  pointer operator->() const { return pointer(**this); }
+  reference operator[](difference_type n) const { return (*_list)[_i + n]; }
+
+  StopTimeListIt& operator++() {
+    ++_i;
+    return *this;
+  }
+  StopTimeListIt operator++(int) {
+    StopTimeListIt ret = *this;
+    ++_i;
+    return ret;
+  }
+  StopTimeListIt& operator--() {
+    --_i;
+    return *this;
+  }
+  StopTimeListIt operator--(int) {
+    StopTimeListIt ret = *this;
+    --_i;
+    return ret;
+  }
+
+  StopTimeListIt& operator+=(difference_type n) {
+    _i += n;
+    return *this;
+  }
+  StopTimeListIt& operator-=(difference_type n) {
+    _i -= n;
+    return *this;
+  }
+  StopTimeListIt operator+(difference_type n) const {
+    return StopTimeListIt(_list, _i + n);
+  }
+  StopTimeListIt operator-(difference_type n) const {
+    return StopTimeListIt(_list, _i - n);
+  }
+  friend StopTimeListIt operator+(difference_type n,
+                                  const StopTimeListIt& it) {
+    return it + n;
+  }
+
+  // iterators and const_iterators can be compared and subtracted
+  template <typename L, typename R>
+  difference_type operator-(const StopTimeListIt<L, R>& o) const {
+    return static_cast<difference_type>(_i) -
+           static_cast<difference_type>(o._i);
+  }
+  template <typename L, typename R>
+  bool operator==(const StopTimeListIt<L, R>& o) const {
+    return _i == o._i;
+  }
+  template <typename L, typename R>
+  bool operator!=(const StopTimeListIt<L, R>& o) const {
+    return _i != o._i;
+  }
+  template <typename L, typename R>
+  bool operator<(const StopTimeListIt<L, R>& o) const {
+    return _i < o._i;
+  }
+  template <typename L, typename R>
+  bool operator>(const StopTimeListIt<L, R>& o) const {
+    return _i > o._i;
+  }
+  template <typename L, typename R>
+  bool operator<=(const StopTimeListIt<L, R>& o) const {
+    return _i <= o._i;
+  }
+  template <typename L, typename R>
+  bool operator>=(const StopTimeListIt<L, R>& o) const {
+    return _i >= o._i;
+  }
+
+ private:
+  template <typename, typename>
+  friend class StopTimeListIt;
+
+  ListT* _list;
+  size_t _i;
+};
+
+// The stop times of a trip, stored in parallel arrays: the stops, and the
+// arrival and departure times, sequence numbers, pickup and drop off types
+// and timepoint flags packed into 64 bits. Distances are only stored once a
+// stop time has one, and headsigns and continuous pickup and drop off values
+// only for the stop times which have them. This takes 16 bytes per stop time
+// in most feeds.
+template <typename StopTimeT>
+class StopTimeList {
+ public:
+  typedef typename StopTimeT::StopRef StopRef;
+  typedef typename StopTimeT::Text Text;
+  typedef StopTimeT value_type;
+  typedef const StopTimeRef<StopTimeT> reference;
+  typedef const StopTimeT const_reference;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef StopTimeListIt<StopTimeList, StopTimeRef<StopTimeT>> iterator;
+  typedef StopTimeListIt<const StopTimeList, StopTimeT> const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  StopTimeList() {}
+  StopTimeList(const StopTimeList& o);
+  StopTimeList(StopTimeList&& o) = default;
+
+  StopTimeList& operator=(StopTimeList o) {
+    _stops.swap(o._stops);
+    _times.swap(o._times);
+    _extra.swap(o._extra);
+    return *this;
+  }
+
+  size_t size() const { return _stops.size(); }
+  bool empty() const { return _stops.empty(); }
+
+  // The i-th stop time. The stop times of a const list are assembled from
+  // the arrays, and const, so that they cannot be changed by mistake.
+  reference operator[](size_t i) { return StopTimeRef<StopTimeT>(this, i); }
+  const_reference operator[](size_t i) const { return get(i); }
+  reference at(size_t i) { return (*this)[check(i)]; }
+  const_reference at(size_t i) const { return (*this)[check(i)]; }
+  reference front() { return (*this)[0]; }
+  const_reference front() const { return (*this)[0]; }
+  reference back() { return (*this)[size() - 1]; }
+  const_reference back() const { return (*this)[size() - 1]; }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  // fields of the i-th stop time, without assembling it
+  StopRef getStop(size_t i) const { return _stops[i]; }
+  uint16_t getSeq(size_t i) const {
+    return static_cast<uint16_t>(_times[i] >> SEQ_SHIFT);
+  }
+
+  void push_back(const StopTimeT& st) { insert(size(), st); }
+  void pop_back() { erase(size() - 1, size()); }
+
+  // Inserts st before the i-th stop time. If headsign is given, it is stored
+  // instead of the headsign of st.
+  void insert(size_t i, const StopTimeT& st) {
+    insert(i, st, st.getHeadsignText());
+  }
+  void insert(size_t i, const StopTimeT& st, Text headsign);
+  iterator insert(const_iterator pos, const StopTimeT& st) {
+    size_t i = pos - cbegin();
+    insert(i, st);
+    return begin() + i;
+  }
+
+  // removes the stop times [from, to)
+  void erase(size_t from, size_t to);
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+  iterator erase(const_iterator first, const_iterator last) {
+    size_t i = first - cbegin();
+    erase(i, last - cbegin());
+    return begin() + i;
+  }
+
+  void clear();
+  void reserve(size_t n) {
+    _stops.reserve(n);
+    _times.reserve(n);
+  }
+
+  void setShapeDistanceTravelled(size_t i, float d);
+
+  // sorts the stop times by their sequence numbers
+  void sort();
+
+  void shrink_to_fit();
+
+ private:
+  friend class StopTimeRef<StopTimeT>;
+
+  // the bits of _times, each time is stored as its hours, minutes and
+  // seconds in 8, 6 and 6 bits
+  static const int DEP_SHIFT = 20;
+  static const int SEQ_SHIFT = 40;
+  static const int PICKUP_SHIFT = 56;
+  static const int DROPOFF_SHIFT = 58;
+  static const int TIMEPOINT_SHIFT = 60;
+
+  // continuous drop off and pickup values, packed as drop off << 2 | pickup
+  static const uint8_t DEF_CONTINUOUS = 1 << 2 | 1;
+
+  // the rarely used fields, which are allocated once they are needed
+  struct Extra {
+    // the distances of all stop times, -1 if not set
+    std::vector<float> dists;
+
+    // the non-empty headsigns and the non-default continuous values, sorted
+    // by the positions of their stop times
+    std::vector<std::pair<uint32_t, Text>> headsigns;
+    std::vector<std::pair<uint32_t, uint8_t>> continuous;
+  };
+
+  std::vector<StopRef> _stops;
+  std::vector<uint64_t> _times;
+  std::unique_ptr<Extra> _extra;
+
+  Extra& extra();
+
+  // the i-th stop time
+  StopTimeT get(size_t i) const;
+
+  // the fields of the i-th stop time which StopTimeRef reads
+  flat::Time getArrivalTime(size_t i) const { return unpackTime(_times[i]); }
+  flat::Time getDepartureTime(size_t i) const {
+    return unpackTime(_times[i] >> DEP_SHIFT);
+  }
+  typename StopTimeT::PU_DO_TYPE getPickupType(size_t i) const {
+    return static_cast<typename StopTimeT::PU_DO_TYPE>(_times[i] >>
+                                                       PICKUP_SHIFT & 3);
+  }
+  typename StopTimeT::PU_DO_TYPE getDropOffType(size_t i) const {
+    return static_cast<typename StopTimeT::PU_DO_TYPE>(_times[i] >>
+                                                       DROPOFF_SHIFT & 3);
+  }
+  bool isTimepoint(size_t i) const { return _times[i] >> TIMEPOINT_SHIFT & 1; }
+  float getShapeDistanceTravelled(size_t i) const;
+  const Text& getHeadsignText(size_t i) const;
+  uint8_t getContinuous(size_t i) const;
+
+  // i, or throws std::out_of_range if it is not a position of the list
+  size_t check(size_t i) const;
+
+  // Replaces the i-th stop time by st, with headsign instead of the headsign
+  // of st.
+  void set(size_t i, const StopTimeT& st, Text headsign);
+
+  // the fields of the i-th stop time which are stored in _extra, kept apart
+  // from get() so that it stays small enough to be inlined
+  void getExtra(size_t i, float* dist, Text* hs, uint8_t* cont) const;
+
+  static uint64_t packTime(const flat::Time& t);
+  static flat::Time unpackTime(uint64_t t);
+
+  // the value stored for position i in side, or 0
+  template <typename V>
+  static const V* find(const std::vector<std::pair<uint32_t, V>>& side,
+                       size_t i);
+
+  // stores v for position i in side
+  template <typename V>
+  static void put(std::vector<std::pair<uint32_t, V>>* side, size_t i, V v);
+
+  // removes the value for position i from side, if there is one
+  template <typename V>
+  static void erase(std::vector<std::pair<uint32_t, V>>* side, size_t i);
+
+  // moves the values for positions >= i in side one position back
+  template <typename V>
+  static void shift(std::vector<std::pair<uint32_t, V>>* side, size_t i);
+
+  // removes the values for positions [from, to) from side, and moves the
+  // values for positions >= to to - from positions forward
+  template <typename V>
+  static void erase(std::vector<std::pair<uint32_t, V>>* side, size_t from,
+                    size_t to);
+
+  // the headsign of stop times without one
+  static const Text NO_HEADSIGN;
+};
+
+#include "StopTimeList.tpp"
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_STOPTIMELIST_H_
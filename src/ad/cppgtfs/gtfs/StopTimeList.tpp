@@ -0,0 +1,308 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const int StopTimeList<StopTimeT>::DEP_SHIFT;
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const int StopTimeList<StopTimeT>::SEQ_SHIFT;
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const int StopTimeList<StopTimeT>::PICKUP_SHIFT;
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const int StopTimeList<StopTimeT>::DROPOFF_SHIFT;
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const int StopTimeList<StopTimeT>::TIMEPOINT_SHIFT;
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const uint8_t StopTimeList<StopTimeT>::DEF_CONTINUOUS;
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const typename StopTimeList<StopTimeT>::Text
+    StopTimeList<StopTimeT>::NO_HEADSIGN;
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+StopTimeList<StopTimeT>::StopTimeList(const StopTimeList& o)
+    : _stops(o._stops),
+      _times(o._times),
+      _extra(o._extra ? new Extra(*o._extra) : 0) {}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+uint64_t StopTimeList<StopTimeT>::packTime(const flat::Time& t) {
+  return static_cast<uint64_t>(t.h) << 12 | t.m << 6 | t.s;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+flat::Time StopTimeList<StopTimeT>::unpackTime(uint64_t t) {
+  return flat::Time(t >> 12 & 0xFF, t >> 6 & 0x3F, t & 0x3F);
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+typename StopTimeList<StopTimeT>::Extra& StopTimeList<StopTimeT>::extra() {
+  if (!_extra) _extra.reset(new Extra());
+  return *_extra;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+template <typename V>
+const V* StopTimeList<StopTimeT>::find(
+    const std::vector<std::pair<uint32_t, V>>& side, size_t i) {
+  auto it = std::lower_bound(
+      side.begin(), side.end(), i,
+      [](const std::pair<uint32_t, V>& e, size_t i) { return e.first < i; });
+  if (it == side.end() || it->first != i) return 0;
+  return &it->second;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+template <typename V>
+void StopTimeList<StopTimeT>::put(std::vector<std::pair<uint32_t, V>>* side,
+                                  size_t i, V v) {
+  auto it = std::lower_bound(
+      side->begin(), side->end(), i,
+      [](const std::pair<uint32_t, V>& e, size_t i) { return e.first < i; });
+  if (it != side->end() && it->first == i)
+    it->second = std::move(v);
+  else
+    side->insert(it, std::pair<uint32_t, V>(i, std::move(v)));
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+template <typename V>
+void StopTimeList<StopTimeT>::erase(std::vector<std::pair<uint32_t, V>>* side,
+                                    size_t i) {
+  auto it = std::lower_bound(
+      side->begin(), side->end(), i,
+      [](const std::pair<uint32_t, V>& e, size_t i) { return e.first < i; });
+  if (it != side->end() && it->first == i) side->erase(it);
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+template <typename V>
+void StopTimeList<StopTimeT>::shift(std::vector<std::pair<uint32_t, V>>* side,
+                                    size_t i) {
+  for (auto it = side->rbegin(); it != side->rend() && it->first >= i; ++it)
+    it->first++;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+template <typename V>
+void StopTimeList<StopTimeT>::erase(std::vector<std::pair<uint32_t, V>>* side,
+                                    size_t from, size_t to) {
+  auto cmp = [](const std::pair<uint32_t, V>& e, size_t i) {
+    return e.first < i;
+  };
+  auto first = std::lower_bound(side->begin(), side->end(), from, cmp);
+  auto last = std::lower_bound(first, side->end(), to, cmp);
+  for (auto it = last; it != side->end(); ++it) it->first -= to - from;
+  side->erase(first, last);
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+size_t StopTimeList<StopTimeT>::check(size_t i) const {
+  if (i >= size()) throw std::out_of_range("StopTimeList::at");
+  return i;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+float StopTimeList<StopTimeT>::getShapeDistanceTravelled(size_t i) const {
+  if (!_extra || _extra->dists.empty()) return -1;
+  return _extra->dists[i];
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+const typename StopTimeList<StopTimeT>::Text&
+StopTimeList<StopTimeT>::getHeadsignText(size_t i) const {
+  const Text* h = _extra ? find(_extra->headsigns, i) : 0;
+  return h ? *h : NO_HEADSIGN;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+uint8_t StopTimeList<StopTimeT>::getContinuous(size_t i) const {
+  const uint8_t* c = _extra ? find(_extra->continuous, i) : 0;
+  return c ? *c : DEF_CONTINUOUS;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+StopTimeT StopTimeList<StopTimeT>::get(size_t i) const {
+  typedef typename StopTimeT::PU_DO_TYPE PU_DO_TYPE;
+
+  uint64_t t = _times[i];
+  float dist = -1;
+  Text hs;
+  uint8_t cont = DEF_CONTINUOUS;
+
+  if (_extra) getExtra(i, &dist, &hs, &cont);
+
+  return StopTimeT(unpackTime(t), unpackTime(t >> DEP_SHIFT), _stops[i],
+                   getSeq(i), std::move(hs),
+                   static_cast<PU_DO_TYPE>(t >> PICKUP_SHIFT & 3),
+                   static_cast<PU_DO_TYPE>(t >> DROPOFF_SHIFT & 3), dist,
+                   t >> TIMEPOINT_SHIFT & 1, cont >> 2, cont & 3);
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::getExtra(size_t i, float* dist, Text* hs,
+                                       uint8_t* cont) const {
+  if (!_extra->dists.empty()) *dist = _extra->dists[i];
+  const Text* h = find(_extra->headsigns, i);
+  if (h) *hs = *h;
+  const uint8_t* c = find(_extra->continuous, i);
+  if (c) *cont = *c;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::insert(size_t i, const StopTimeT& st,
+                                     Text headsign) {
+  _stops.insert(_stops.begin() + i, st.getStop());
+  _times.insert(_times.begin() + i, 0);
+
+  if (_extra) {
+    if (!_extra->dists.empty())
+      _extra->dists.insert(_extra->dists.begin() + i, -1);
+    shift(&_extra->headsigns, i);
+    shift(&_extra->continuous, i);
+  }
+
+  set(i, st, std::move(headsign));
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::set(size_t i, const StopTimeT& st,
+                                  Text headsign) {
+  _stops[i] = st.getStop();
+  _times[i] = packTime(st.getArrivalTime()) |
+              packTime(st.getDepartureTime()) << DEP_SHIFT |
+              static_cast<uint64_t>(st.getSeq()) << SEQ_SHIFT |
+              static_cast<uint64_t>(st.getPickupType() & 3) << PICKUP_SHIFT |
+              static_cast<uint64_t>(st.getDropOffType() & 3) << DROPOFF_SHIFT |
+              static_cast<uint64_t>(st.isTimepoint()) << TIMEPOINT_SHIFT;
+
+  if (st.getShapeDistanceTravelled() != -1)
+    setShapeDistanceTravelled(i, st.getShapeDistanceTravelled());
+  else if (_extra && !_extra->dists.empty())
+    _extra->dists[i] = -1;
+
+  if (!headsign.empty())
+    put(&extra().headsigns, i, std::move(headsign));
+  else if (_extra)
+    erase(&_extra->headsigns, i);
+
+  uint8_t cont = (st.getContinuousDropOff() & 3) << 2 |
+                 (st.getContinuousPickup() & 3);
+  if (cont != DEF_CONTINUOUS)
+    put(&extra().continuous, i, cont);
+  else if (_extra)
+    erase(&_extra->continuous, i);
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::erase(size_t from, size_t to) {
+  _stops.erase(_stops.begin() + from, _stops.begin() + to);
+  _times.erase(_times.begin() + from, _times.begin() + to);
+
+  if (!_extra) return;
+
+  if (!_extra->dists.empty())
+    _extra->dists.erase(_extra->dists.begin() + from,
+                        _extra->dists.begin() + to);
+  erase(&_extra->headsigns, from, to);
+  erase(&_extra->continuous, from, to);
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::clear() {
+  _stops.clear();
+  _times.clear();
+  _extra.reset();
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::setShapeDistanceTravelled(size_t i, float d) {
+  std::vector<float>& dists = extra().dists;
+  if (dists.empty()) dists.assign(size(), -1);
+  dists[i] = d;
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::sort() {
+  std::vector<uint32_t> order(size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+    return getSeq(a) < getSeq(b);
+  });
+
+  std::vector<StopRef> stops(order.size());
+  std::vector<uint64_t> times(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    stops[i] = _stops[order[i]];
+    times[i] = _times[order[i]];
+  }
+  _stops.swap(stops);
+  _times.swap(times);
+
+  if (!_extra) return;
+
+  if (!_extra->dists.empty()) {
+    std::vector<float> dists(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+      dists[i] = _extra->dists[order[i]];
+    _extra->dists.swap(dists);
+  }
+
+  // the new position of each stop time
+  std::vector<uint32_t> pos(order.size());
+  for (size_t i = 0; i < order.size(); i++) pos[order[i]] = i;
+
+  auto cmp = [](const std::pair<uint32_t, Text>& a,
+                const std::pair<uint32_t, Text>& b) {
+    return a.first < b.first;
+  };
+  for (auto& e : _extra->headsigns) e.first = pos[e.first];
+  std::sort(_extra->headsigns.begin(), _extra->headsigns.end(), cmp);
+
+  for (auto& e : _extra->continuous) e.first = pos[e.first];
+  std::sort(_extra->continuous.begin(), _extra->continuous.end());
+}
+
+// ____________________________________________________________________________
+template <typename StopTimeT>
+void StopTimeList<StopTimeT>::shrink_to_fit() {
+  _stops.shrink_to_fit();
+  _times.shrink_to_fit();
+  if (!_extra) return;
+  _extra->dists.shrink_to_fit();
+  _extra->headsigns.shrink_to_fit();
+  _extra->continuous.shrink_to_fit();
+}
@@ -0,0 +1,101 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#include <cstring>
+#include <string>
+#include "StringPool.h"
+
+using ad::cppgtfs::gtfs::PoolString;
+using ad::cppgtfs::gtfs::StringPool;
+
+const size_t StringPool::SHARDS;
+const size_t StringPool::CHUNK_S;
+const uint32_t StringPool::EMPTY;
+
+// _____________________________________________________________________________
+uint64_t StringPool::hash(const char* s, size_t len) {
+  // FNV-1a
+  uint64_t h = 14695981039346656037ull;
+  for (size_t i = 0; i < len; i++) {
+    h ^= static_cast<unsigned char>(s[i]);
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+// _____________________________________________________________________________
+PoolString StringPool::get(const char* s, size_t len) {
+  if (len == 0) return PoolString();
+
+  // the upper bits choose the shard, the lower ones the slot
+  uint64_t h64 = hash(s, len);
+  uint32_t h = static_cast<uint32_t>(h64);
+  Shard& shard = _shards[(h64 >> 32) % SHARDS];
+  std::unique_lock<std::mutex> lock(shard.m);
+
+  size_t mask = shard.slots.size() - 1;
+  size_t i = h & mask;
+  for (; shard.slots[i] != EMPTY; i = (i + 1) & mask) {
+    uint32_t e = shard.slots[i];
+    if (shard.hashes[e] != h) continue;
+    PoolString p(shard.strings[e]);
+    if (p.size() == len && memcmp(p.data(), s, len) == 0) return p;
+  }
+
+  shard.slots[i] = shard.strings.size();
+  shard.strings.push_back(shard.store(s, len));
+  shard.hashes.push_back(h);
+
+  // keep the table at most half full
+  if (2 * shard.strings.size() > shard.slots.size()) shard.grow();
+
+  return PoolString(shard.strings.back());
+}
+
+// _____________________________________________________________________________
+const char* StringPool::Shard::store(const char* s, size_t len) {
+  size_t need = sizeof(uint32_t) + len;
+  char* p;
+
+  if (need > CHUNK_S) {
+    // a chunk of its own, inserted before the current one
+    chunks.emplace_back(new char[need]);
+    p = chunks.back().get();
+    if (chunks.size() > 1) std::swap(chunks.back(), chunks[chunks.size() - 2]);
+  } else {
+    if (used + need > CHUNK_S) {
+      chunks.emplace_back(new char[CHUNK_S]);
+      used = 0;
+    }
+    p = chunks.back().get() + used;
+    used += need;
+  }
+
+  uint32_t l = len;
+  memcpy(p, &l, sizeof(l));
+  memcpy(p + sizeof(l), s, len);
+  return p;
+}
+
+// _____________________________________________________________________________
+void StringPool::Shard::grow() {
+  slots.assign(slots.size() * 2, EMPTY);
+  size_t mask = slots.size() - 1;
+
+  for (size_t e = 0; e < hashes.size(); e++) {
+    size_t i = hashes[e] & mask;
+    while (slots[i] != EMPTY) i = (i + 1) & mask;
+    slots[i] = e;
+  }
+}
+
+// _____________________________________________________________________________
+size_t StringPool::size() const {
+  size_t ret = 0;
+  for (const auto& shard : _shards) {
+    std::unique_lock<std::mutex> lock(shard.m);
+    ret += shard.strings.size();
+  }
+  return ret;
+}
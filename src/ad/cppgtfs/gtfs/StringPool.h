@@ -0,0 +1,127 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_CPPGTFS_GTFS_STRINGPOOL_H_
+#define AD_CPPGTFS_GTFS_STRINGPOOL_H_
+
+#include <stdint.h>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// A text field of an entity of a pooled feed (see PooledFeed): a handle to
+// a string in the StringPool of the feed, which has to outlive it. Copies
+// refer to the same string. The bytes are not stored as a std::string, so
+// the value is returned by value by str().
+class PoolString {
+ public:
+  PoolString() : _p(0) {}
+
+  std::string str() const { return std::string(data(), size()); }
+  operator std::string() const { return str(); }
+
+  // the bytes of the string, which are not 0-terminated
+  const char* data() const { return _p ? _p + sizeof(uint32_t) : ""; }
+  size_t size() const {
+    if (!_p) return 0;
+    uint32_t len;
+    memcpy(&len, _p, sizeof(len));
+    return len;
+  }
+
+  bool empty() const { return _p == 0; }
+
+  bool operator==(const PoolString& o) const { return _p == o._p; }
+  bool operator!=(const PoolString& o) const { return _p != o._p; }
+
+  bool operator==(const std::string& s) const {
+    return size() == s.size() && memcmp(data(), s.data(), s.size()) == 0;
+  }
+  bool operator!=(const std::string& s) const { return !(*this == s); }
+
+ private:
+  friend class StringPool;
+
+  // p points to the length of the string, followed by its bytes
+  explicit PoolString(const char* p) : _p(p) {}
+
+  const char* _p;
+};
+
+inline bool operator==(const std::string& s, const PoolString& p) {
+  return p == s;
+}
+inline bool operator!=(const std::string& s, const PoolString& p) {
+  return p != s;
+}
+inline std::ostream& operator<<(std::ostream& o, const PoolString& p) {
+  return o.write(p.data(), p.size());
+}
+
+// A feed-wide set of immutable strings. Equal strings are stored only once,
+// and never move or change until the pool is destroyed.
+//
+// The strings are stored one after another in large chunks of bytes, each
+// preceded by its length, and looked up in a flat table with open
+// addressing on their stored hashes, like the ids of an ad::util::IdMap.
+class StringPool {
+ public:
+  StringPool() {}
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  // Returns a handle to the copy of the len bytes at s in the pool, which
+  // is added if needed. Can be called from several threads at once.
+  PoolString get(const char* s, size_t len);
+  PoolString get(const std::string& s) { return get(s.data(), s.size()); }
+
+  // the number of distinct strings in the pool
+  size_t size() const;
+
+ private:
+  // the pool is split into shards by hash, which are locked on their own
+  static const size_t SHARDS = 16;
+
+  // the size of a chunk, longer strings get a chunk of their own
+  static const size_t CHUNK_S = 64 * 1024;
+
+  static const uint32_t EMPTY = UINT32_MAX;
+
+  struct Shard {
+    Shard() : slots(16, EMPTY), used(CHUNK_S) {}
+
+    mutable std::mutex m;
+
+    // the slots hold the positions of the strings below
+    std::vector<uint32_t> slots;
+
+    // the strings, and the lower 32 bits of their hash
+    std::vector<const char*> strings;
+    std::vector<uint32_t> hashes;
+
+    // the chunks the strings are stored in, and the bytes used in the last
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t used;
+
+    const char* store(const char* s, size_t len);
+    void grow();
+  };
+
+  static uint64_t hash(const char* s, size_t len);
+
+  Shard _shards[SHARDS];
+};
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_STRINGPOOL_H_
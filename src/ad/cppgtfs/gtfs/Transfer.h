@@ -27,7 +27,7 @@ class Transfer {
   typedef flat::Transfer::TYPE TYPE;
   Transfer() {}
 
-  Transfer(Stop* fromStop, Stop* toStop, Route* fromRoute, Route* toRoute,
+  Transfer(StopT* fromStop, StopT* toStop, RouteT* fromRoute, RouteT* toRoute,
            TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* fromTrip,
            TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* toTrip, TYPE type,
            int32_t tTime)
@@ -40,13 +40,13 @@ class Transfer {
         _type(type),
         _tTime(tTime) {}
 
-  Stop* getFromStop() const { return _fromStop; }
+  StopT* getFromStop() const { return _fromStop; }
 
-  Stop* getToStop() const { return _toStop; }
+  StopT* getToStop() const { return _toStop; }
 
-  Route* getFromRoute() const { return _fromRoute; }
+  RouteT* getFromRoute() const { return _fromRoute; }
 
-  Route* getToRoute() const { return _toRoute; }
+  RouteT* getToRoute() const { return _toRoute; }
 
   TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* getFromTrip() const {
     return _fromTrip;
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <utility>
 
 #include "Frequency.h"
 #include "Route.h"
@@ -17,6 +18,7 @@
 #include "Shape.h"
 #include "Stop.h"
 #include "StopTime.h"
+#include "StopTimeList.h"
 #include "flat/Trip.h"
 
 using std::exception;
@@ -29,12 +31,13 @@ namespace gtfs {
 template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
 class TripB {
-  // typedef std::set<StopTimeT, StopTimeCompare<StopTimeT>> StopTimes;
-  typedef std::vector<StopTimeT> StopTimes;
+  typedef StopTimeList<StopTimeT> StopTimes;
   typedef std::vector<Frequency> Frequencies;
 
  public:
   typedef TripB<StopTimeT, ServiceT, RouteT, ShapeT>* Ref;
+  // the type of the text fields, the one of the routes
+  typedef typename RouteT::Text Text;
   static std::string getId(Ref r) { return r->getId(); }
 
   typedef flat::Trip::WC_BIKE_ACCESSIBLE WC_BIKE_ACCESSIBLE;
@@ -42,19 +45,19 @@ class TripB {
 
   TripB() {}
   TripB(const std::string& id, typename RouteT::Ref r, typename ServiceT::Ref s,
-        const std::string& hs, const std::string& short_name, DIRECTION dir,
-        const std::string& blockid, typename ShapeT::Ref shp,
-        WC_BIKE_ACCESSIBLE wc, WC_BIKE_ACCESSIBLE ba);
+        Text hs, Text short_name, DIRECTION dir, Text blockid,
+        typename ShapeT::Ref shp, WC_BIKE_ACCESSIBLE wc,
+        WC_BIKE_ACCESSIBLE ba);
 
   const std::string& getId() const;
   const typename RouteT::Ref getRoute() const;
   typename RouteT::Ref getRoute();
   typename ServiceT::Ref getService();
   const typename ServiceT::Ref getService() const;
-  const std::string& getHeadsign() const;
-  const std::string& getShortname() const;
+  const Text& getHeadsign() const;
+  const Text& getShortname() const;
   DIRECTION getDirection() const;
-  const std::string& getBlockId() const;
+  const Text& getBlockId() const;
   const typename ShapeT::Ref getShape() const;
   typename ShapeT::Ref getShape();
   void setShape(typename ShapeT::Ref shp);
@@ -81,10 +84,10 @@ class TripB {
   std::string _id;
   typename RouteT::Ref _route;
   typename ServiceT::Ref _service;
-  std::string _headsign;
-  std::string _short_name;
+  Text _headsign;
+  Text _short_name;
   DIRECTION _dir;
-  std::string _block_id;
+  Text _block_id;
   typename ShapeT::Ref _shape;
   WC_BIKE_ACCESSIBLE _wc;
   WC_BIKE_ACCESSIBLE _ba;
@@ -7,16 +7,15 @@ template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
 TripB<StopTimeT, ServiceT, RouteT, ShapeT>::TripB(
     const std::string& id, typename RouteT::Ref r, typename ServiceT::Ref s,
-    const std::string& hs, const std::string& short_name, DIRECTION dir,
-    const std::string& blockid, typename ShapeT::Ref shp, WC_BIKE_ACCESSIBLE wc,
-    WC_BIKE_ACCESSIBLE ba)
+    Text hs, Text short_name, DIRECTION dir, Text blockid,
+    typename ShapeT::Ref shp, WC_BIKE_ACCESSIBLE wc, WC_BIKE_ACCESSIBLE ba)
     : _id(id),
       _route(r),
       _service(s),
-      _headsign(hs),
-      _short_name(short_name),
+      _headsign(std::move(hs)),
+      _short_name(std::move(short_name)),
       _dir(dir),
-      _block_id(blockid),
+      _block_id(std::move(blockid)),
       _shape(shp),
       _wc(wc),
       _ba(ba) {}
@@ -62,16 +61,16 @@ TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getService() const {
 // _____________________________________________________________________________
 template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
-const std::string& TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getHeadsign()
-    const {
+const typename TripB<StopTimeT, ServiceT, RouteT, ShapeT>::Text&
+TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getHeadsign() const {
   return _headsign;
 }
 
 // _____________________________________________________________________________
 template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
-const std::string& TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getShortname()
-    const {
+const typename TripB<StopTimeT, ServiceT, RouteT, ShapeT>::Text&
+TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getShortname() const {
   return _short_name;
 }
 
@@ -86,8 +85,8 @@ TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getDirection() const {
 // _____________________________________________________________________________
 template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
-const std::string& TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getBlockId()
-    const {
+const typename TripB<StopTimeT, ServiceT, RouteT, ShapeT>::Text&
+TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getBlockId() const {
   return _block_id;
 }
 
@@ -167,13 +166,23 @@ template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
 bool TripB<StopTimeT, ServiceT, RouteT, ShapeT>::addStopTime(
     const StopTimeT& t) {
-  for (size_t i = 0; i < _stoptimes.size(); i++) {
-    if (_stoptimes[i].getSeq() == t.getSeq()) return false;
+  // stop times are usually added in order
+  size_t n = _stoptimes.size();
+  if (n == 0 || _stoptimes.getSeq(n - 1) < t.getSeq()) {
+    _stoptimes.push_back(t);
+    return true;
   }
-  _stoptimes.reserve(_stoptimes.size() + 1);
-  _stoptimes.push_back(t);
-  auto cmp = StopTimeCompare<StopTimeT>();
-  std::sort(_stoptimes.begin(), _stoptimes.end(), cmp);
+
+  size_t lo = 0, hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (_stoptimes.getSeq(mid) < t.getSeq())
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo != n && _stoptimes.getSeq(lo) == t.getSeq()) return false;
+  _stoptimes.insert(lo, t);
   return true;
 }
 
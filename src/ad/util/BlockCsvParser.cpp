@@ -0,0 +1,149 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "BlockCsvParser.h"
+
+using ad::util::BlockCsvParser;
+
+// _____________________________________________________________________________
+BlockCsvParser::~BlockCsvParser() { stop(); }
+
+// _____________________________________________________________________________
+void BlockCsvParser::stop() {
+  if (!_reader.joinable()) return;
+  {
+    std::unique_lock<std::mutex> lock(_m);
+    _stop = true;
+  }
+  _cv.notify_all();
+  _reader.join();
+}
+
+// _____________________________________________________________________________
+void BlockCsvParser::init(bool threaded) {
+  // if blocks are filled on demand, two blocks suffice
+  _blocks.resize(threaded ? 4 : 2);
+  for (auto& b : _blocks) b.buf.resize(BUFFER_S + BLOCK_S + 1);
+
+  if (threaded) _reader = std::thread(&BlockCsvParser::work, this);
+}
+
+// _____________________________________________________________________________
+void BlockCsvParser::work() {
+  while (true) {
+    Block* b;
+    {
+      // the block of the current line must not be overwritten
+      std::unique_lock<std::mutex> lock(_m);
+      _cv.wait(lock,
+               [&] { return _stop || _produced < _cur + _blocks.size(); });
+      if (_stop) return;
+      b = &_blocks[_produced % _blocks.size()];
+    }
+
+    fill(b);
+    bool eof = b->size == 0 || b->err;
+
+    {
+      std::unique_lock<std::mutex> lock(_m);
+      _produced++;
+    }
+    _cv.notify_all();
+
+    if (eof) return;
+  }
+}
+
+// _____________________________________________________________________________
+void BlockCsvParser::fill(Block* b) {
+  // only BLOCK_S bytes are read, to always have space for the 0 byte
+  b->size = 0;
+  b->err = nullptr;
+  try {
+    while (b->size < BLOCK_S) {
+      size_t bytesRead =
+          read(b->buf.data() + BUFFER_S + b->size, BLOCK_S - b->size);
+      if (bytesRead == 0) break;
+      b->size += bytesRead;
+    }
+  } catch (...) {
+    // may be on the background thread, so rethrown by nextBlock()
+    b->err = std::current_exception();
+  }
+}
+
+// _____________________________________________________________________________
+bool BlockCsvParser::nextBlock() {
+  if (_eof) return false;
+
+  size_t next = _started ? _cur + 1 : 0;
+  Block& b = _blocks[next % _blocks.size()];
+
+  if (_reader.joinable()) {
+    std::unique_lock<std::mutex> lock(_m);
+    _cv.wait(lock, [&] { return _produced > next; });
+  } else {
+    fill(&b);
+  }
+
+  if (b.err) {
+    _eof = true;
+    std::rethrow_exception(b.err);
+  }
+
+  if (b.size == 0) {
+    _eof = true;
+    return false;
+  }
+
+  // move the incomplete last line of the current block in front of the
+  // data of the next block. Lines longer than BUFFER_S are cut.
+  size_t tail = std::min(_end - _pos, BUFFER_S);
+  memcpy(b.buf.data() + BUFFER_S - tail, _lineBuff + _pos, tail);
+
+  _lineBuff = b.buf.data();
+  _pos = BUFFER_S - tail;
+  _end = BUFFER_S + b.size;
+
+  {
+    std::unique_lock<std::mutex> lock(_m);
+    _cur = next;
+    _started = true;
+  }
+  _cv.notify_all();
+
+  return true;
+}
+
+// _____________________________________________________________________________
+std::pair<size_t, size_t> BlockCsvParser::fetchLine() {
+  if (_blocks.empty()) return {0, 0};
+
+  while (true) {
+    auto lineEnd =
+        static_cast<char*>(memchr(_lineBuff + _pos, '\n', _end - _pos));
+
+    if (lineEnd) {
+      // the line break is kept in the range and will be replaced by a 0 byte
+      // in readNextLine()
+      size_t start = _pos;
+      _pos = (lineEnd - _lineBuff) + 1;
+      return {start, _pos};
+    }
+
+    if (!nextBlock()) break;
+  }
+
+  // last line without a trailing line break
+  if (_pos == _end) return {0, 0};
+
+  size_t start = _pos;
+  _lineBuff[_end] = 0;
+  _pos = _end;
+  return {start, _end};
+}
@@ -0,0 +1,83 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_UTIL_BLOCKCSVPARSER_H_
+#define AD_UTIL_BLOCKCSVPARSER_H_
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CsvParser.h"
+
+/**
+ * Base class for CSV parsers reading from a source which has to be
+ * decompressed, like a ZIP member. The source is read in large blocks, and
+ * lines are tokenized in place in these blocks.
+ */
+namespace ad {
+namespace util {
+
+// the size of the blocks a source is read into
+static const size_t BLOCK_S = 1 << 20;
+
+class BlockCsvParser : public CsvParser {
+ public:
+  virtual ~BlockCsvParser();
+
+  virtual std::pair<size_t, size_t> fetchLine();
+
+ protected:
+  // Starts reading from the source. If threaded is true, blocks are read on
+  // a background thread while lines are parsed.
+  void init(bool threaded);
+
+  // Stops the background thread. Has to be called by the destructors of
+  // subclasses before the source is closed.
+  void stop();
+
+  // Reads at most n bytes of the source into buf. Returns the number of bytes
+  // read, 0 at the end of the source. Throws a CsvParserException if the
+  // source cannot be read, which is rethrown when the lines are read up to
+  // the failed block.
+  virtual size_t read(char* buf, size_t n) = 0;
+
+ private:
+  // A block of data. Each block has room for BUFFER_S bytes in front of the
+  // data, where the incomplete last line of the previous block is moved to.
+  struct Block {
+    std::vector<char> buf;
+    size_t size = 0;
+    // the error reading the block, if any
+    std::exception_ptr err;
+  };
+
+  std::vector<Block> _blocks;
+
+  // the number of the current block, and the range of unread data in it
+  size_t _cur = 0;
+  size_t _pos = 0;
+  size_t _end = 0;
+  bool _started = false;
+  bool _eof = false;
+
+  // the background reading, if threaded
+  std::thread _reader;
+  std::mutex _m;
+  std::condition_variable _cv;
+  size_t _produced = 0;
+  bool _stop = false;
+
+  void work();
+  void fill(Block* b);
+  bool nextBlock();
+};
+}  // namespace util
+}  // namespace ad
+
+#endif  // AD_UTIL_BLOCKCSVPARSER_H_
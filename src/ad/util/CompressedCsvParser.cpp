@@ -0,0 +1,218 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef ZLIB_FOUND
+#include <zlib.h>
+#endif
+#ifdef ZSTD_FOUND
+#include <zstd.h>
+#endif
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "CompressedCsvParser.h"
+
+using ad::util::CompressedCsvParser;
+
+// _____________________________________________________________________________
+struct CompressedCsvParser::Decoder {
+  enum FORMAT : uint8_t { GZIP = 0, ZSTD = 1 };
+
+  explicit Decoder(FORMAT f) : format(f) {
+#ifdef ZLIB_FOUND
+    if (format == GZIP) {
+      memset(&zs, 0, sizeof(zs));
+      // 16 selects the gzip header
+      ok = inflateInit2(&zs, 15 + 16) == Z_OK;
+    }
+#endif
+#ifdef ZSTD_FOUND
+    if (format == ZSTD) {
+      zds = ZSTD_createDStream();
+      ok = zds != 0;
+    }
+#endif
+  }
+
+  ~Decoder() {
+#ifdef ZLIB_FOUND
+    if (format == GZIP && ok) inflateEnd(&zs);
+#endif
+#ifdef ZSTD_FOUND
+    if (format == ZSTD) ZSTD_freeDStream(zds);
+#endif
+  }
+
+  // Prepares for the next of several concatenated streams
+  void reset() {
+#ifdef ZLIB_FOUND
+    if (format == GZIP) inflateReset(&zs);
+#endif
+  }
+
+  // Decompresses from in to out, and sets the number of bytes consumed and
+  // produced. end is set if a stream was completed. Returns false on errors.
+  bool decode(const char* in, size_t inSize, size_t* inRead, char* out,
+              size_t outSize, size_t* written, bool* end) {
+#ifdef ZLIB_FOUND
+    if (format == GZIP) {
+      zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+      zs.avail_in = inSize;
+      zs.next_out = reinterpret_cast<Bytef*>(out);
+      zs.avail_out = outSize;
+      int r = inflate(&zs, Z_NO_FLUSH);
+      *inRead = inSize - zs.avail_in;
+      *written = outSize - zs.avail_out;
+      *end = r == Z_STREAM_END;
+      return r == Z_OK || r == Z_STREAM_END || r == Z_BUF_ERROR;
+    }
+#endif
+#ifdef ZSTD_FOUND
+    if (format == ZSTD) {
+      ZSTD_inBuffer ib = {in, inSize, 0};
+      ZSTD_outBuffer ob = {out, outSize, 0};
+      size_t r = ZSTD_decompressStream(zds, &ob, &ib);
+      *inRead = ib.pos;
+      *written = ob.pos;
+      *end = r == 0;
+      return !ZSTD_isError(r);
+    }
+#endif
+    (void)in;
+    (void)inSize;
+    (void)inRead;
+    (void)out;
+    (void)outSize;
+    (void)written;
+    (void)end;
+    return false;
+  }
+
+  FORMAT format;
+  // whether the decompression state could be set up
+  bool ok = false;
+#ifdef ZLIB_FOUND
+  z_stream zs;
+#endif
+#ifdef ZSTD_FOUND
+  ZSTD_DStream* zds = 0;
+#endif
+};
+
+// _____________________________________________________________________________
+const std::vector<std::string>& CompressedCsvParser::getSuffixes() {
+  static const std::vector<std::string> suffixes = {
+#ifdef ZSTD_FOUND
+      ".zst",
+#endif
+#ifdef ZLIB_FOUND
+      ".gz",
+#endif
+  };
+  return suffixes;
+}
+
+// _____________________________________________________________________________
+CompressedCsvParser::CompressedCsvParser(const std::string& path,
+                                         bool threaded)
+    : _readablePath(path) {
+  auto endsWith = [&path](const char* suffix) {
+    size_t l = strlen(suffix);
+    return path.size() >= l && path.compare(path.size() - l, l, suffix) == 0;
+  };
+
+  std::unique_ptr<Decoder> dec;
+#ifdef ZSTD_FOUND
+  if (endsWith(".zst")) dec.reset(new Decoder(Decoder::ZSTD));
+#endif
+#ifdef ZLIB_FOUND
+  if (endsWith(".gz")) dec.reset(new Decoder(Decoder::GZIP));
+#endif
+  (void)endsWith;
+
+  if (!dec || !dec->ok) return;
+
+  _fd = open(path.c_str(), O_RDONLY);
+  if (_fd < 0) return;
+
+  // everything was successful
+  _dec.swap(dec);
+  _in.resize(BLOCK_S);
+
+  init(threaded);
+  try {
+    readNextLine();
+    parseHeader();
+  } catch (...) {
+    // the reading thread must not outlive the decoder
+    stop();
+    close(_fd);
+    throw;
+  }
+}
+
+// _____________________________________________________________________________
+CompressedCsvParser::~CompressedCsvParser() {
+  // the reading thread must not outlive the decoder
+  stop();
+  if (_fd >= 0) close(_fd);
+}
+
+// _____________________________________________________________________________
+bool CompressedCsvParser::isGood() const { return _dec != 0; }
+
+// _____________________________________________________________________________
+bool CompressedCsvParser::fillInput() {
+  ssize_t bytesRead = ::read(_fd, _in.data(), _in.size());
+  if (bytesRead < 0) {
+    _done = true;
+    throw CsvParserException("cannot read compressed file", -1, "", -1,
+                             _readablePath);
+  }
+  _inPos = 0;
+  _inSize = bytesRead;
+  return _inSize > 0;
+}
+
+// _____________________________________________________________________________
+size_t CompressedCsvParser::read(char* buf, size_t n) {
+  while (!_done) {
+    if (_inPos == _inSize && !fillInput()) {
+      _done = true;
+      if (_ended) break;
+      throw CsvParserException("unexpected end of compressed file", -1, "",
+                               -1, _readablePath);
+    }
+
+    size_t inRead = 0, written = 0;
+    bool end = false;
+    bool ok = _dec->decode(_in.data() + _inPos, _inSize - _inPos, &inRead,
+                           buf, n, &written, &end);
+    _inPos += inRead;
+
+    // with input and room for output, the decoder always makes progress
+    if (!ok || (!inRead && !written && !end)) {
+      _done = true;
+      throw CsvParserException("corrupt compressed file", -1, "", -1,
+                               _readablePath);
+    }
+
+    _ended = end;
+    if (end) {
+      // concatenated streams are decompressed one after another
+      if (_inPos == _inSize && !fillInput())
+        _done = true;
+      else
+        _dec->reset();
+    }
+
+    if (written) return written;
+  }
+
+  return 0;
+}
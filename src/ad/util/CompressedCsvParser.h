@@ -0,0 +1,66 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_UTIL_COMPRESSEDCSVPARSER_H_
+#define AD_UTIL_COMPRESSEDCSVPARSER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BlockCsvParser.h"
+
+/**
+ * A parser for CSV files compressed on their own with gzip (.gz) or
+ * Zstandard (.zst). The files are decompressed while they are parsed,
+ * without temporary files.
+ */
+namespace ad {
+namespace util {
+
+class CompressedCsvParser : public BlockCsvParser {
+ public:
+  // Initializes the parser by opening the compressed file at path and
+  // reading the table header. The format is determined by the suffix of
+  // path. If threaded is true, the file is decompressed on a background
+  // thread while lines are parsed. The parser is not good if the file
+  // cannot be opened, or if cppgtfs was built without support for the
+  // format. Reading lines throws a CsvParserException if the file is
+  // corrupt or ends before its last stream does.
+  CompressedCsvParser(const std::string& path, bool threaded);
+
+  virtual ~CompressedCsvParser();
+
+  // The suffixes of the supported formats, in order of preference
+  static const std::vector<std::string>& getSuffixes();
+
+  virtual bool isGood() const;
+  virtual const std::string& getReadablePath() const { return _readablePath; }
+
+ protected:
+  virtual size_t read(char* buf, size_t n);
+
+ private:
+  // the decompression state, which depends on the format
+  struct Decoder;
+
+  int _fd = -1;
+  std::unique_ptr<Decoder> _dec;
+  std::string _readablePath;
+
+  // the compressed input, read in blocks
+  std::vector<char> _in;
+  size_t _inPos = 0;
+  size_t _inSize = 0;
+  bool _done = false;
+
+  // whether the last stream read was completed
+  bool _ended = false;
+
+  bool fillInput();
+};
+}  // namespace util
+}  // namespace ad
+
+#endif  // AD_UTIL_COMPRESSEDCSVPARSER_H_
@@ -3,24 +3,143 @@
 // Authors: Hannah Bast <bast@informatik.uni-freiburg.de>,
 //          Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <clocale>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
 #include <limits>
 #include <string>
+#include <utility>
 
 #include "CsvParser.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AD_UTIL_CSV_X86 1
+#include <immintrin.h>
+#endif
+
 using ad::util::CsvParser;
 using std::remove;
 
 namespace ad {
 namespace util {
-// cached first 10 powers of 10
-static int pow10[10] = {1,      10,      100,      1000,      10000,
-                        100000, 1000000, 10000000, 100000000, 1000000000};
+
+// Bitmasks of the positions of commas and quotes in a block of 32 bytes
+struct BlockMasks {
+  uint32_t commas;
+  uint32_t quotes;
+};
+
+typedef BlockMasks (*ClassifyFunc)(const char* p);
+
+// _____________________________________________________________________________
+static inline bool isSpace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// _____________________________________________________________________________
+static BlockMasks classifyBlockScalar(const char* p, size_t n) {
+  BlockMasks m = {0, 0};
+  for (size_t i = 0; i < n; i++) {
+    if (p[i] == ',') m.commas |= 1u << i;
+    if (p[i] == '"') m.quotes |= 1u << i;
+  }
+  return m;
+}
+
+#ifdef AD_UTIL_CSV_X86
+// _____________________________________________________________________________
+__attribute__((target("sse2"))) static BlockMasks classifyBlockSse2(
+    const char* p) {
+  const __m128i c = _mm_set1_epi8(',');
+  const __m128i q = _mm_set1_epi8('"');
+  __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+
+  BlockMasks m;
+  m.commas = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, c))) |
+             (static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, c)))
+              << 16);
+  m.quotes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, q))) |
+             (static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, q)))
+              << 16);
+  return m;
+}
+
+// _____________________________________________________________________________
+__attribute__((target("avx2"))) static BlockMasks classifyBlockAvx2(
+    const char* p) {
+  __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+  BlockMasks m;
+  m.commas = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+  m.quotes = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))));
+  return m;
+}
+#endif
+
+// _____________________________________________________________________________
+static BlockMasks classifyBlockGeneric(const char* p) {
+  return classifyBlockScalar(p, 32);
+}
+
+// _____________________________________________________________________________
+static ClassifyFunc getClassifyFunc() {
+#ifdef AD_UTIL_CSV_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return &classifyBlockAvx2;
+  if (__builtin_cpu_supports("sse2")) return &classifyBlockSse2;
+#endif
+  return &classifyBlockGeneric;
+}
+
+// _____________________________________________________________________________
+// classifies the 32 bytes at p, using the widest instruction set available
+static BlockMasks classifyBlock(const char* p) {
+  // chosen once at runtime, depending on the instruction sets of the CPU
+  static const ClassifyFunc f = getClassifyFunc();
+  return f(p);
+}
+
+// the amount of read data after which the pages of a mapping are released
+static const size_t RELEASE_S = 1 << 20;
+
+// powers of 10 which are exactly representable as doubles
+static const double pow10[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// _____________________________________________________________________________
+// converts the len characters of the decimal number at s with strtod(), with
+// a '.' as the decimal point, whatever the LC_NUMERIC of the program using the
+// parser is. Returns false if strtod() does not read exactly len characters.
+static bool strtodC(const char* s, size_t len, double* ret) {
+  const char* dp = localeconv()->decimal_point;
+  char* end = 0;
+
+  if (dp[0] == '.' && dp[1] == 0) {
+    *ret = std::strtod(s, &end);
+    return end == s + len;
+  }
+
+  // replace the '.' by the decimal point of the locale
+  std::string tmp(s, len);
+  size_t pos = tmp.find('.');
+  if (pos != std::string::npos) tmp.replace(pos, 1, dp);
+  *ret = std::strtod(tmp.c_str(), &end);
+  return end == tmp.c_str() + tmp.size();
+}
 }  // namespace util
 }  // namespace ad
 
@@ -28,7 +147,9 @@ static int pow10[10] = {1,      10,      100,      1000,      10000,
 CsvParser::CsvParser() : _stream(0) {}
 
 // _____________________________________________________________________________
-CsvParser::~CsvParser() {}
+CsvParser::~CsvParser() {
+  if (_map) munmap(_map, _mapSize);
+}
 
 // _____________________________________________________________________________
 CsvParser::CsvParser(std::istream* stream, const std::string& readablePath)
@@ -47,16 +168,118 @@ CsvParser::CsvParser(std::istream* stream)
 // _____________________________________________________________________________
 CsvParser::CsvParser(const std::string& path)
     : _stream(&_ifstream), _readablePath(path) {
-  _ifstream.open(path);
+  if (!mmapFile(path, 0, std::numeric_limits<size_t>::max()))
+    _ifstream.open(path);
   readNextLine();
   parseHeader();
 }
 
 // _____________________________________________________________________________
-bool CsvParser::isGood() const { return _stream != 0 && _stream->good(); }
+CsvParser::CsvParser(const std::string& path, size_t offset, size_t size,
+                     const std::string& readablePath)
+    : _stream(0), _readablePath(readablePath) {
+  if (!mmapFile(path, offset, size)) return;
+  readNextLine();
+  parseHeader();
+}
+
+// _____________________________________________________________________________
+CsvParser::CsvParser(const char* data, size_t size,
+                     const std::string& readablePath)
+    : _stream(&_ifstream), _readablePath(readablePath) {
+  // an empty buffer behaves like an empty file, the unopened stream yields
+  // no lines
+  if (size) {
+    _data = data;
+    _dataSize = size;
+  }
+  readNextLine();
+  parseHeader();
+}
+
+// _____________________________________________________________________________
+CsvParser::CsvParser(std::unique_ptr<char[]> data, size_t size,
+                     const std::string& readablePath)
+    : CsvParser(static_cast<const char*>(data.get()), size, readablePath) {
+  _ownedData = std::move(data);
+}
+
+// _____________________________________________________________________________
+CsvParser::CsvParser(const CsvParser& parent, const CsvChunk& chunk)
+    : _curLine(chunk.firstLine - 1),
+      _headerMap(parent._headerMap),
+      _headerVec(parent._headerVec),
+      _stream(0),
+      _data(chunk.begin),
+      _dataSize(chunk.end - chunk.begin),
+      _readablePath(parent.getReadablePath()) {}
+
+// _____________________________________________________________________________
+bool CsvParser::isGood() const {
+  if (_data) return true;
+  return _stream != 0 && _stream->good();
+}
+
+// _____________________________________________________________________________
+bool CsvParser::mmapFile(const std::string& path, size_t offset, size_t size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat s;
+  if (fstat(fd, &s) != 0 || !S_ISREG(s.st_mode) ||
+      offset >= static_cast<size_t>(s.st_size)) {
+    close(fd);
+    return false;
+  }
+
+  size = std::min(size, static_cast<size_t>(s.st_size) - offset);
+  if (size == 0) {
+    close(fd);
+    return false;
+  }
+
+  // mappings have to start at a page boundary
+  size_t pageOffset = offset % sysconf(_SC_PAGESIZE);
+
+  void* m = mmap(0, size + pageOffset, PROT_READ, MAP_PRIVATE, fd,
+                 offset - pageOffset);
+  close(fd);
+
+  if (m == MAP_FAILED) return false;
+
+  madvise(m, size + pageOffset, MADV_SEQUENTIAL);
+
+  _map = static_cast<char*>(m);
+  _mapSize = size + pageOffset;
+  _released = 0;
+  _data = _map + pageOffset;
+  _dataSize = size;
+  _dataPos = 0;
+
+  return true;
+}
 
 // _____________________________________________________________________________
 std::pair<size_t, size_t> CsvParser::fetchLine() {
+  if (_data) {
+    if (_dataPos >= _dataSize) return {0, 0};
+
+    size_t start = _dataPos;
+    auto lineEnd = static_cast<const char*>(
+        memchr(_data + start, '\n', _dataSize - start));
+
+    // the line break is kept in the range and will be skipped in
+    // readNextLine(). The last line may not have one.
+    _dataPos = lineEnd ? (lineEnd - _data) + 1 : _dataSize;
+
+    // the range is in _data, which is read in place. Mapped pages are only
+    // read, so they stay shared with the page cache.
+    if (_map && _data + start >= _map + _released + RELEASE_S)
+      release(_data + start);
+
+    return {start, _dataPos};
+  }
+
   if (!_stream->good()) return {0, 0};
 
   _stream->getline(_buff, BUFFER_S);
@@ -66,47 +289,171 @@ std::pair<size_t, size_t> CsvParser::fetchLine() {
   return {0, readN};
 }
 
+// _____________________________________________________________________________
+std::vector<ad::util::CsvChunk> CsvParser::getChunks(size_t chunkSize) {
+  std::vector<CsvChunk> ret;
+  if (!_data) return ret;
+
+  // chunks always end after a line break (or at the end of the data), so
+  // they contain exactly the lines readNextLine() would have returned. The
+  // lines are counted to keep line numbers in errors and warnings intact.
+  const char* end = _data + _dataSize;
+  const char* p = _data + _dataPos;
+  int32_t line = _curLine + 1;
+
+  while (p < end) {
+    CsvChunk c = {p, 0, line};
+    const char* target =
+        p + std::min(chunkSize, static_cast<size_t>(end - p));
+
+    while (p < end) {
+      auto nl = static_cast<const char*>(memchr(p, '\n', end - p));
+      if (!nl) {
+        // the last line, without a trailing line break
+        line++;
+        p = end;
+        break;
+      }
+      line++;
+      p = nl + 1;
+      if (p >= target) break;
+    }
+
+    c.end = p;
+    ret.push_back(c);
+
+    // the chunks may be read much later, their pages are not kept until then
+    release(c.begin, c.end);
+  }
+
+  _chunkLines = line - (_curLine + 1);
+  _numBytes += _dataSize - _dataPos;
+  _dataPos = _dataSize;
+  return ret;
+}
+
+// _____________________________________________________________________________
+void CsvParser::release(const char* p) {
+  if (!_map || p <= _map) return;
+
+  // only whole pages before p
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t end = std::min(static_cast<size_t>(p - _map), _mapSize);
+  end -= end % pageSize;
+  if (end <= _released) return;
+
+  madvise(_map + _released, end - _released, MADV_DONTNEED);
+  _released = end;
+}
+
+// _____________________________________________________________________________
+void CsvParser::release(const char* begin, const char* end) {
+  if (!_map || end <= _map) return;
+
+  // only whole pages in the range
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t from = begin > _map ? begin - _map : 0;
+  size_t to = std::min(static_cast<size_t>(end - _map), _mapSize);
+  from += (pageSize - from % pageSize) % pageSize;
+  to -= to % pageSize;
+  if (to <= from) return;
+
+  madvise(_map + from, to - from, MADV_DONTNEED);
+}
+
 // _____________________________________________________________________________
 bool CsvParser::readNextLine() {
   auto range = fetchLine();
   if (range.first >= range.second) return false;
 
   _curLine++;
+  _numBytes += range.second - range.first;
 
+  // lines of _data are read in place, without writing to them
+  const char* line = (_data ? _data : _lineBuff) + range.first;
   size_t lineLen = range.second - range.first;
-  size_t s = range.first;
 
-  // Remove new line characters
-  while (_buff[s + lineLen - 1] == '\r' || _buff[s + lineLen - 1] == '\n') {
-    _buff[s + lineLen - 1] = 0;
+  // Skip new line characters (and the 0 byte std::istream::getline leaves
+  // in the read count)
+  while (lineLen > 0 &&
+         (line[lineLen - 1] == '\r' || line[lineLen - 1] == '\n' ||
+          line[lineLen - 1] == 0)) {
     lineLen--;
   }
 
   if (lineLen == 0) return readNextLine();
 
+  _line = line;
+  _lineLen = lineLen;
+  _writableLine = _data ? 0 : _lineBuff + range.first;
+  _terminated = false;
+
   size_t pos = 0;
+  _fields.clear();
+
+  if (lineLen > 2 && static_cast<signed char>(line[0]) == -17 &&
+      static_cast<signed char>(line[1]) == -69 &&
+      static_cast<signed char>(line[2]) == -65) {
+    pos = 3;
+  }
+
+  // classify the line in blocks of 32 bytes. As long as no quote occurs,
+  // fields are delimited by the commas in the block bitmasks. Once a quote
+  // is found, the remainder of the line is handed to the quote-aware
+  // tokenizer, starting at the current field.
+  size_t fieldStart = pos;
+  for (size_t blk = pos; blk < lineLen; blk += 32) {
+    size_t n = std::min(static_cast<size_t>(32), lineLen - blk);
+    BlockMasks m = n == 32 ? classifyBlock(line + blk)
+                           : classifyBlockScalar(line + blk, n);
+
+    uint32_t commas = m.commas;
+    if (m.quotes) commas &= (m.quotes & (~m.quotes + 1)) - 1;
+
+    while (commas) {
+      size_t end = blk + __builtin_ctz(commas);
+      commas &= commas - 1;
+      pushItem(line, fieldStart, end);
+      fieldStart = end + 1;
+    }
+
+    if (m.quotes) {
+      tokenizeQuoted(fieldStart);
+      return true;
+    }
+  }
+
+  // last field, may be empty if the line ends with a comma
+  pushItem(line, fieldStart, lineLen);
+
+  return true;
+}
+
+// _____________________________________________________________________________
+void CsvParser::tokenizeQuoted(size_t pos) {
   size_t lastPos = pos;
   bool firstChar = false;
   bool esc = false;
   int esc_quotes_found = 0;
-  _currentItems.clear();
-  _currentModItems.clear();
 
-  if (lineLen > 2 && static_cast<signed char>(_buff[s]) == -17 &&
-      static_cast<signed char>(_buff[s + 1]) == -69 &&
-      static_cast<signed char>(_buff[s + 2]) == -65) {
-    pos = 3;
-    lastPos = pos;
-  }
+  // the next occurrence of c in the line at or after from, or the line end
+  auto find = [this](char c, size_t from) {
+    auto r = static_cast<const char*>(memchr(_line + from, c, _lineLen - from));
+    return r ? static_cast<size_t>(r - _line) : _lineLen;
+  };
+
+  // the line end is visited as well, so that a line ending with a comma has
+  // an empty last field
+  while (pos <= _lineLen) {
+    char c = pos < _lineLen ? _line[pos] : 0;
 
-  while (pos < lineLen) {
-    if (!firstChar && std::isspace(_buff[s + pos])) {
+    if (!firstChar && std::isspace(c)) {
       pos++;
       lastPos = pos;
       continue;
     }
 
-    if (_buff[s + pos] == '"' && !esc) {
+    if (c == '"' && !esc) {
       esc = true;
       pos++;
       lastPos = pos;
@@ -115,87 +462,112 @@ bool CsvParser::readNextLine() {
 
     firstChar = true;
 
+    // the end of the field
+    size_t end;
+
     if (!esc) {
-      const char* c = strchr(_buff + s + pos, ',');
-      if (c)
-        pos = (c - _buff) - s;
-      else
-        pos = lineLen - 1;
+      end = pos = find(',', pos);
     } else {
-      const char* c = strchr(_buff + s + pos, '"');
-      if (c)
-        pos = (c - _buff) - s;
-      else
-        pos = lineLen - 1;
-
-      if (pos < lineLen - 1 && _buff[pos + s + 1] == '"') {
-        pos += 2;
+      end = find('"', pos);
+      if (end == _lineLen) {
+        // unterminated quotes, the field extends to the end of the line
+        pos = _lineLen;
+        esc = false;
+      } else if (end < _lineLen - 1 && _line[end + 1] == '"') {
+        pos = end + 2;
         esc_quotes_found++;
         continue;
       } else {
         // we end this field here, because of the closing quotes
         // see CSV spec at http://tools.ietf.org/html/rfc4180#page-2
-        _buff[s + pos] = 0;
         esc = false;
-        firstChar = false;
-
-        const char* c = strchr(_buff + s + pos + 1, ',');
-        if (c)
-          pos = (c - _buff) - s;
-        else
-          pos = lineLen - 1;
+        pos = find(',', end + 1);
       }
     }
 
-    if (_buff[s + pos] == ',') {
-      _buff[s + pos] = 0;
-      firstChar = false;
-    }
+    // pos is at a comma or at the line end
+    firstChar = false;
 
-    if (!esc_quotes_found) {
-      _currentItems.push_back(inlineRightTrim(_buff + s + lastPos));
-    } else {
-      size_t p = -1;
+    size_t len = end - lastPos;
+    if (esc_quotes_found) len = unescapeQuotes(lastPos, len);
+    esc_quotes_found = 0;
 
-      // we have to modify to string (that is, we have to remove
-      // characters. create a copy of this item
-      // on the line-wise modified vector
-      _currentModItems.push_back(_buff + s + lastPos);
+    while (len > 0 && std::isspace(_line[lastPos + len - 1])) len--;
+    _fields.emplace_back(lastPos, len);
 
-      while (esc_quotes_found) {
-        p = _currentModItems.back().find("\"\"", p + 1);
-        if (p != std::string::npos) {
-          _currentModItems.back().replace(p, 2, "\"");
-        }
+    lastPos = ++pos;
+  }
+}
 
-        esc_quotes_found--;
-      }
+// _____________________________________________________________________________
+size_t CsvParser::unescapeQuotes(size_t pos, size_t len) {
+  // unescaped strings are never longer than the escaped ones, so quote
+  // escapes can be removed in place, once the line may be written to
+  makeWritable();
+  char* s = _writableLine + pos;
+  size_t w = 0;
+  for (size_t r = 0; r < len; r++, w++) {
+    s[w] = s[r];
+    if (s[r] == '"' && r + 1 < len && s[r + 1] == '"') r++;
+  }
+  return w;
+}
 
-      // pointers will point to strings on the modified string vector
-      _currentItems.push_back(inlineRightTrim(_currentModItems.back().c_str()));
-    }
+// _____________________________________________________________________________
+void CsvParser::pushItem(const char* line, size_t start, size_t end) {
+  while (start < end && isSpace(line[start])) start++;
+  while (end > start && isSpace(line[end - 1])) end--;
+  _fields.emplace_back(start, end - start);
+}
 
-    lastPos = ++pos;
+// _____________________________________________________________________________
+void CsvParser::makeWritable() const {
+  if (_writableLine) return;
+
+  // the line is followed by the 0 byte of its last item
+  _writableLine = _buff;
+  if (_lineLen >= BUFFER_S) {
+    _longLine.resize(_lineLen + 1);
+    _writableLine = _longLine.data();
   }
-  return true;
+  memcpy(_writableLine, _line, _lineLen);
+  _line = _writableLine;
+}
+
+// _____________________________________________________________________________
+void CsvParser::terminate() const {
+  makeWritable();
+  for (const auto& f : _fields) _writableLine[f.first + f.second] = 0;
+  _terminated = true;
 }
 
 // _____________________________________________________________________________
 const char* CsvParser::getTString(const size_t i) const {
-  return _currentItems[i];
+  if (!_terminated) terminate();
+  return _line + _fields[i].first;
+}
+
+// _____________________________________________________________________________
+const char* CsvParser::getTString(const size_t i, char* buf, size_t n) const {
+  if (_terminated || _fields[i].second >= n) return getTString(i);
+  memcpy(buf, _line + _fields[i].first, _fields[i].second);
+  buf[_fields[i].second] = 0;
+  return buf;
 }
 
 // _____________________________________________________________________________
 double CsvParser::getDouble(const size_t i) const {
-  if (i >= _currentItems.size())
+  if (i >= _fields.size())
     throw CsvParserException("expected float number", i, getFieldName(i),
                              _curLine, _readablePath);
 
+  // numbers are converted from a copy on the stack
+  char buf[64];
   bool fail = false;
-  double ret = atof(_currentItems[i], 38, &fail);
+  double ret = atof(getTString(i, buf, sizeof(buf)), &fail);
   if (fail) {
     std::string a = "expected float number, found ";
-    a += _currentItems[i];
+    a += getTString(i, buf, sizeof(buf));
     throw CsvParserException(a, i, getFieldName(i), _curLine, _readablePath);
   }
   return ret;
@@ -203,11 +575,12 @@ double CsvParser::getDouble(const size_t i) const {
 
 // _____________________________________________________________________________
 int32_t CsvParser::getLong(const size_t i) const {
-  if (i >= _currentItems.size())
+  if (i >= _fields.size())
     throw CsvParserException("expected integer number", i, getFieldName(i),
                              _curLine, _readablePath);
+  char buf[32];
   bool fail = false;
-  uint32_t ret = atoi(_currentItems[i], &fail);
+  uint32_t ret = atoi(getTString(i, buf, sizeof(buf)), &fail);
   if (fail)
     throw CsvParserException("expected integer number", i, getFieldName(i),
                              _curLine, _readablePath);
@@ -221,12 +594,12 @@ bool CsvParser::hasItem(const std::string& fieldName) const {
 
 // _____________________________________________________________________________
 bool CsvParser::fieldIsEmpty(const std::string& fieldName) const {
-  return strlen(getTString(fieldName)) == 0;
+  return fieldIsEmpty(getFieldIndex(fieldName));
 }
 
 // _____________________________________________________________________________
 bool CsvParser::fieldIsEmpty(size_t field) const {
-  return strlen(getTString(field)) == 0;
+  return _fields[field].second == 0;
 }
 
 // _____________________________________________________________________________
@@ -245,7 +618,7 @@ int32_t CsvParser::getLong(const std::string& fieldName) const {
 }
 
 // _____________________________________________________________________________
-size_t CsvParser::getNumColumns() const { return _currentItems.size(); }
+size_t CsvParser::getNumColumns() const { return _fields.size(); }
 
 // _____________________________________________________________________________
 size_t CsvParser::getFieldIndex(const string& fieldName) const {
@@ -282,14 +655,6 @@ void CsvParser::parseHeader() {
   }
 }
 
-// _____________________________________________________________________________
-const char* CsvParser::inlineRightTrim(const char* t) const {
-  char* s = const_cast<char*>(t);
-  char* end = s + std::strlen(s) - 1;
-  while (std::isspace(*end)) *end-- = 0;
-  return s;
-}
-
 // ___________________________________________________________________________
 inline uint32_t CsvParser::atoi(const char* p, bool* fail) {
   uint32_t x = 0;
@@ -302,45 +667,95 @@ inline uint32_t CsvParser::atoi(const char* p, bool* fail) {
 }
 
 // ___________________________________________________________________________
-inline double CsvParser::atof(const char* p, uint8_t mn, bool* fail) {
-  // this atof implementation works only on "normal" float strings like
-  // 56.445 or -345.00, but should be faster than std::atof
-  double ret = 0.0;
+double CsvParser::atof(const char* p, bool* fail) {
+  // decimal strings like 56.445, -345.00 or +1.5e-3 are first read into a
+  // 64 bit mantissa and a decimal exponent. If the mantissa fits into the 53
+  // bits of a double and the exponent is small enough, both are exactly
+  // representable and a single multiplication or division gives the
+  // correctly rounded result (Clinger's fast path). All other values are
+  // handed to strtod(), with a '.' as the decimal point in any locale.
+  //
+  // Only a trailing space may follow the number. Unlike in earlier versions,
+  // values like 52.5x or 5.5.5 fail, also in non-strict mode.
+  const char* start = p;
   bool neg = false;
-  bool decSep = false;
   if (*p == '-') {
     neg = true;
     p++;
+  } else if (*p == '+') {
+    p++;
   }
 
-  while (*p >= '0' && *p <= '9') {
-    ret = ret * 10.0 + (*p - '0');
-    p++;
+  uint64_t mant = 0;
+  int digits = 0;
+  int exp = 0;
+  bool trunc = false;
+
+  for (; *p >= '0' && *p <= '9'; p++) {
+    if (digits < 19) {
+      mant = mant * 10 + (*p - '0');
+      if (mant) digits++;
+    } else {
+      exp++;
+      if (*p != '0') trunc = true;
+    }
   }
 
   if (*p == '.') {
-    if (decSep) {
+    p++;
+    for (; *p >= '0' && *p <= '9'; p++) {
+      if (digits < 19) {
+        mant = mant * 10 + (*p - '0');
+        if (mant) digits++;
+        exp--;
+      } else if (*p != '0') {
+        trunc = true;
+      }
+    }
+  }
+
+  if (*p == 'e' || *p == 'E') {
+    p++;
+    bool expNeg = false;
+    if (*p == '-') {
+      expNeg = true;
+      p++;
+    } else if (*p == '+') {
+      p++;
+    }
+
+    if (*p < '0' || *p > '9') {
       *fail = true;
       return 0;
     }
-    decSep = true;
-    p++;
-    double f = 0;
-    uint8_t n = 0;
 
-    for (; n < mn && *p >= '0' && *p <= '9'; n++, p++) {
-      f = f * 10.0 + (*p - '0');
+    int e = 0;
+    for (; *p >= '0' && *p <= '9'; p++) {
+      if (e < 100000) e = e * 10 + (*p - '0');
     }
+    exp += expNeg ? -e : e;
+  }
 
-    if (n < 10)
-      ret += f / ad::util::pow10[n];
-    else
-      ret += f / std::pow(10, n);
-  } else if (*p != 0 && *p != ' ') {
+  if (*p != 0 && *p != ' ') {
     *fail = true;
     return 0;
   }
 
-  if (neg) return -ret;
+  if (mant == 0) return neg ? -0.0 : 0.0;
+
+  if (!trunc && mant <= (uint64_t(1) << 53) && exp >= -22 && exp <= 22) {
+    double ret = static_cast<double>(mant);
+    if (exp < 0)
+      ret /= ad::util::pow10[-exp];
+    else
+      ret *= ad::util::pow10[exp];
+    return neg ? -ret : ret;
+  }
+
+  double ret;
+  if (!ad::util::strtodC(start, p - start, &ret)) {
+    *fail = true;
+    return 0;
+  }
   return ret;
 }
@@ -12,9 +12,11 @@
 #include <fstream>
 #include <iostream>
 #include <istream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 using std::exception;
@@ -32,6 +34,22 @@ namespace util {
 
 static const size_t BUFFER_S = 50000;
 
+// A range of whole lines in the data of a parser, which can be parsed
+// independently of the remaining data
+struct CsvChunk {
+  const char* begin;
+  const char* end;
+  // the number of the first line in the chunk
+  int32_t firstLine;
+};
+
+// A field of the current line of a parser: len bytes at begin, which are
+// not 0-terminated
+struct CsvField {
+  const char* begin;
+  size_t len;
+};
+
 class CsvParserException : public exception {
  public:
   CsvParserException(std::string msg, int index, std::string fieldName,
@@ -82,20 +100,71 @@ class CsvParser {
   CsvParser(std::istream* stream, const std::string& path);
 
   // Initializes the parser by opening the file and reading the table header.
+  // Regular files are memory-mapped read-only, without reading them through
+  // a stream.
   explicit CsvParser(const std::string& path);
 
+  // Initializes the parser from size bytes at offset of the file at path
+  // (e.g. a member stored without compression in an archive), which are
+  // memory-mapped read-only. If the range cannot be mapped, the parser is
+  // not good.
+  CsvParser(const std::string& path, size_t offset, size_t size,
+            const std::string& readablePath);
+
+  // Initializes the parser from the complete contents of a file, size bytes
+  // at data, which must stay valid while the parser is used. They are never
+  // written to. readablePath is displayed on errors.
+  CsvParser(const char* data, size_t size, const std::string& readablePath);
+
+  // Same as above, the parser takes ownership of data.
+  CsvParser(std::unique_ptr<char[]> data, size_t size,
+            const std::string& readablePath);
+
+  // Initializes a parser for a chunk of the data of another parser, with
+  // the same header. Line numbers continue at the first line of the chunk.
+  CsvParser(const CsvParser& parent, const CsvChunk& chunk);
+
   // Read next line.
   // Returns true iff the line was read successfully.
   bool readNextLine();
 
   virtual std::pair<size_t, size_t> fetchLine();
 
+  // Splits the remaining lines into chunks of roughly chunkSize bytes. The
+  // lines are then consumed and have to be read from the chunks. Returns an
+  // empty vector (and consumes nothing) if the data is not available as a
+  // single buffer. The pages of a memory-mapped file are released after
+  // the lines of a chunk were counted, and read again by its chunk parser.
+  std::vector<CsvChunk> getChunks(size_t chunkSize);
+
+  // Releases the memory of the data before p, which has been read. Only
+  // has an effect for memory-mapped files, whose pages are read from the
+  // file again if they are accessed later.
+  void release(const char* p);
+
+  // Releases the memory of the data from begin to end, like release(), for
+  // data read out of order, e.g. a chunk. Pages which also hold data
+  // outside of the range are kept.
+  void release(const char* begin, const char* end);
+
   // Getters for i-th column from current line. Prerequisite: i < _numColumns.
   // Second arguments are default values.
 
-  // returns the i-th column as a trimmed string
+  // Returns the i-th column as a trimmed string. Lines of memory-mapped
+  // files or buffers are tokenized without copying them, so the first call
+  // for such a line copies it, to 0-terminate its columns.
   const char* getTString(const size_t i) const;
 
+  // returns the i-th column as a trimmed string, copied to buf if it is
+  // shorter than n bytes, otherwise like getTString(). For short columns
+  // like numbers or times, this avoids copying the line.
+  const char* getTString(const size_t i, char* buf, size_t n) const;
+
+  // returns the i-th column, without copying or 0-terminating it
+  CsvField getField(const size_t i) const {
+    return {_line + _fields[i].first, _fields[i].second};
+  }
+
   // returns the i-th column as a double
   double getDouble(const size_t i) const;
 
@@ -114,6 +183,11 @@ class CsvParser {
   // returns the line number the parser is currently at
   int32_t getCurLine() const;
 
+  // returns the number of lines and bytes read so far, including those
+  // handed out as chunks
+  int32_t getNumLines() const { return _curLine + _chunkLines; }
+  size_t getNumBytes() const { return _numBytes; }
+
   // checks whether a column with a specific name exists in this file
   bool hasItem(const std::string& fieldName) const;
 
@@ -134,7 +208,7 @@ class CsvParser {
 
   const string getFieldName(size_t i) const;
 
-  virtual const string getReadablePath() const { return _readablePath; }
+  virtual const string& getReadablePath() const { return _readablePath; }
 
   virtual bool isGood() const;
 
@@ -144,26 +218,52 @@ class CsvParser {
   // Parses the header row and fills the header map.
   void parseHeader();
 
-  // returns a trimmed version of a const char*
-  //
-  // careful: this function is not idempotent. it will leave t
-  // right-trimmed.
-  const char* inlineRightTrim(const char* t) const;
+  // Adds the item [start, end) of the current line to the current items,
+  // trimmed
+  void pushItem(const char* line, size_t start, size_t end);
+
+  // Tokenizes the remainder of the current line starting at field start
+  // pos, with support for quoted fields and quote escapes
+  void tokenizeQuoted(size_t pos);
 
   // Map of field names to column indices. Parsed from the
   // table header (first row in a CSV file).
   std::unordered_map<std::string, size_t> _headerMap;
   std::vector<std::string> _headerVec;
 
-  // Pointers to the items in the current line.
-  std::vector<const char*> _currentItems;
+  // The offsets and lengths of the items in the current line.
+  std::vector<std::pair<size_t, size_t>> _fields;
+
+  // the current line, _lineLen bytes without the line break. It is only
+  // written to once it has been made writable.
+  mutable const char* _line = 0;
+  size_t _lineLen = 0;
+
+  // the current line if it is writable, or 0 if it is still read in place
+  mutable char* _writableLine = 0;
 
-  // modified, quote-escaped strings
-  std::vector<std::string> _currentModItems;
+  // whether the items of the current line are 0-terminated
+  mutable bool _terminated = false;
 
-  char _buff[BUFFER_S] = {0};
+  mutable char _buff[BUFFER_S] = {0};
 
-  static double atof(const char* p, uint8_t mn, bool* fail);
+  // The buffer the line range returned by fetchLine() refers to, if the
+  // parser does not read from a single buffer of data. Points to _buff,
+  // except for subclasses reading in larger blocks. Lines in it can be
+  // written to, and need one more byte after their end.
+  char* _lineBuff = _buff;
+
+  // copies the current line to _buff (or _longLine), unless it is writable
+  void makeWritable() const;
+
+  // 0-terminates the items of the current line
+  void terminate() const;
+
+  // removes the quote escapes ("") from the len bytes of the current line
+  // at pos, returns their new length
+  size_t unescapeQuotes(size_t pos, size_t len);
+
+  static double atof(const char* p, bool* fail);
   static uint32_t atoi(const char* p, bool* fail);
 
  private:
@@ -173,6 +273,34 @@ class CsvParser {
   // Used internally if no external stream is provided
   std::ifstream _ifstream;
 
+  // The data of the file as a single buffer, if the parser was initialized
+  // from a path and the file could be mapped, or from a chunk. It is never
+  // written to, lines are tokenized in place, and only copied to the line
+  // buffer if they have to be unescaped or 0-terminated.
+  const char* _data = 0;
+  size_t _dataSize = 0;
+  size_t _dataPos = 0;
+
+  // lines of _data too long for _buff
+  mutable std::vector<char> _longLine;
+
+  // the memory mapping _data points into, if owned by this parser, and the
+  // part of it which has been released
+  char* _map = 0;
+  size_t _mapSize = 0;
+  size_t _released = 0;
+
+  // the file contents, if the parser was initialized from them
+  std::unique_ptr<char[]> _ownedData;
+
+  // the number of lines handed out as chunks, and of bytes read
+  int32_t _chunkLines = 0;
+  size_t _numBytes = 0;
+
+  // maps size bytes at offset of the file at path, or the rest of the file
+  // if size is the maximum size_t
+  bool mmapFile(const std::string& path, size_t offset, size_t size);
+
   std::string _readablePath;
 };
 }  // namespace util
@@ -0,0 +1,80 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_UTIL_IDMAP_H_
+#define AD_UTIL_IDMAP_H_
+
+#include <stdint.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * A map from string ids to pointers, used to resolve ids read from a table.
+ * The ids are interned one after another in a single buffer, and looked up
+ * in a flat table with open addressing, without constructing a string for
+ * the key.
+ */
+namespace ad {
+namespace util {
+
+template <typename T>
+class IdMap {
+ public:
+  IdMap() : _slots(16, EMPTY) {}
+
+  // Returns the value of the id of length len, or 0 if there is none
+  T* get(const char* id, size_t len) const;
+  T* get(const std::string& id) const { return get(id.data(), id.size()); }
+
+  bool has(const char* id, size_t len) const { return find(id, len) != EMPTY; }
+  bool has(const std::string& id) const { return has(id.data(), id.size()); }
+
+  // Adds the id of length len with value val. The id must not be in the map.
+  void add(const char* id, size_t len, T* val);
+  void add(const std::string& id, T* val) { add(id.data(), id.size(), val); }
+
+  size_t size() const { return _vals.size(); }
+
+ private:
+  static const uint32_t EMPTY = UINT32_MAX;
+
+  // the slots hold the positions of the entries below
+  std::vector<uint32_t> _slots;
+
+  // the ids, and the end of each of them in _ids
+  std::vector<char> _ids;
+  std::vector<size_t> _ends;
+
+  std::vector<uint32_t> _hashes;
+  std::vector<T*> _vals;
+
+  static uint32_t hash(const char* id, size_t len);
+  uint32_t find(const char* id, size_t len) const;
+  void grow();
+};
+
+// A set of ids, stored like the ids of an IdMap
+class IdSet {
+ public:
+  bool has(const std::string& id) const { return _map.has(id); }
+
+  // Adds id, if it is not in the set yet
+  void add(const std::string& id) {
+    if (!_map.has(id)) _map.add(id, 0);
+  }
+
+  size_t size() const { return _map.size(); }
+
+ private:
+  IdMap<void> _map;
+};
+
+#include "IdMap.tpp"
+
+}  // namespace util
+}  // namespace ad
+
+#endif  // AD_UTIL_IDMAP_H_
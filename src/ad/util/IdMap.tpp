@@ -0,0 +1,75 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// ____________________________________________________________________________
+template <typename T>
+const uint32_t IdMap<T>::EMPTY;
+
+// ____________________________________________________________________________
+template <typename T>
+uint32_t IdMap<T>::hash(const char* id, size_t len) {
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    h ^= static_cast<unsigned char>(id[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+uint32_t IdMap<T>::find(const char* id, size_t len) const {
+  uint32_t h = hash(id, len);
+  size_t mask = _slots.size() - 1;
+
+  for (size_t i = h & mask;; i = (i + 1) & mask) {
+    uint32_t e = _slots[i];
+    if (e == EMPTY) return EMPTY;
+    if (_hashes[e] != h) continue;
+
+    size_t start = e ? _ends[e - 1] : 0;
+    if (_ends[e] - start == len && memcmp(_ids.data() + start, id, len) == 0)
+      return e;
+  }
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* IdMap<T>::get(const char* id, size_t len) const {
+  uint32_t e = find(id, len);
+  if (e == EMPTY) return 0;
+  return _vals[e];
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void IdMap<T>::add(const char* id, size_t len, T* val) {
+  // keep the table at most half full
+  if (2 * (_vals.size() + 1) > _slots.size()) grow();
+
+  uint32_t h = hash(id, len);
+  size_t mask = _slots.size() - 1;
+  size_t i = h & mask;
+  while (_slots[i] != EMPTY) i = (i + 1) & mask;
+
+  _slots[i] = _vals.size();
+  _ids.insert(_ids.end(), id, id + len);
+  _ends.push_back(_ids.size());
+  _hashes.push_back(h);
+  _vals.push_back(val);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void IdMap<T>::grow() {
+  _slots.assign(_slots.size() * 2, EMPTY);
+  size_t mask = _slots.size() - 1;
+
+  for (size_t e = 0; e < _hashes.size(); e++) {
+    size_t i = _hashes[e] & mask;
+    while (_slots[i] != EMPTY) i = (i + 1) & mask;
+    _slots[i] = e;
+  }
+}
@@ -4,7 +4,13 @@
 //          Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
 #ifdef LIBZIP_FOUND
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <zip.h>
+#ifdef LIBDEFLATE_FOUND
+#include <libdeflate.h>
+#endif
 
 #include <algorithm>
 #include <cmath>
@@ -18,14 +24,123 @@
 
 using ad::util::ZipCsvParser;
 
+namespace ad {
+namespace util {
+
+// _____________________________________________________________________________
+static uint16_t le16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+
+// _____________________________________________________________________________
+static uint32_t le32(const unsigned char* p) {
+  return le16(p) | (static_cast<uint32_t>(le16(p + 2)) << 16);
+}
+
+// _____________________________________________________________________________
+static uint64_t le64(const unsigned char* p) {
+  return le32(p) | (static_cast<uint64_t>(le32(p + 4)) << 32);
+}
+
+// _____________________________________________________________________________
+static bool readAt(int fd, uint64_t offset, size_t n,
+                   std::vector<unsigned char>* buf) {
+  buf->resize(n);
+  size_t r = 0;
+  while (r < n) {
+    ssize_t got = pread(fd, buf->data() + r, n - r, offset + r);
+    if (got <= 0) return false;
+    r += got;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+// finds the offsets of the local headers of the members named in headers in
+// the central directory of the ZIP file fd
+static bool findLocalHeaders(
+    int fd, std::unordered_map<std::string, uint64_t>* headers) {
+  struct stat s;
+  if (fstat(fd, &s) != 0 || s.st_size < 22) return false;
+  uint64_t fileSize = s.st_size;
+
+  // the end of central directory record, followed by a comment of at most
+  // 65535 bytes, and preceded by the ZIP64 locator
+  size_t tailSize = std::min<uint64_t>(fileSize, 22 + 65535 + 20);
+  std::vector<unsigned char> tail;
+  if (!readAt(fd, fileSize - tailSize, tailSize, &tail)) return false;
+
+  size_t eocd = tailSize - 22;
+  while (le32(&tail[eocd]) != 0x06054b50) {
+    if (eocd == 0) return false;
+    eocd--;
+  }
+
+  uint64_t cdSize = le32(&tail[eocd + 12]);
+  uint64_t cdOffset = le32(&tail[eocd + 16]);
+
+  if (cdSize == 0xFFFFFFFF || cdOffset == 0xFFFFFFFF) {
+    if (eocd < 20 || le32(&tail[eocd - 20]) != 0x07064b50) return false;
+    std::vector<unsigned char> eocd64;
+    if (!readAt(fd, le64(&tail[eocd - 12]), 56, &eocd64)) return false;
+    if (le32(&eocd64[0]) != 0x06064b50) return false;
+    cdSize = le64(&eocd64[40]);
+    cdOffset = le64(&eocd64[48]);
+  }
+
+  if (cdOffset + cdSize > fileSize) return false;
+
+  std::vector<unsigned char> cd;
+  if (!readAt(fd, cdOffset, cdSize, &cd)) return false;
+
+  size_t p = 0;
+  while (p + 46 <= cd.size() && le32(&cd[p]) == 0x02014b50) {
+    size_t nameLen = le16(&cd[p + 28]);
+    size_t extraLen = le16(&cd[p + 30]);
+    size_t commentLen = le16(&cd[p + 32]);
+    if (p + 46 + nameLen + extraLen > cd.size()) return false;
+
+    auto h = headers->find(
+        std::string(reinterpret_cast<const char*>(&cd[p + 46]), nameLen));
+
+    if (h != headers->end()) {
+      uint64_t offset = le32(&cd[p + 42]);
+
+      if (offset == 0xFFFFFFFF) {
+        // in the ZIP64 extra field, after the sizes which overflowed
+        size_t e = p + 46 + nameLen;
+        size_t end = e + extraLen;
+        while (e + 4 <= end && le16(&cd[e]) != 0x0001)
+          e += 4 + le16(&cd[e + 2]);
+        if (e + 4 > end) return false;
+
+        size_t f = e + 4;
+        if (le32(&cd[p + 24]) == 0xFFFFFFFF) f += 8;
+        if (le32(&cd[p + 20]) == 0xFFFFFFFF) f += 8;
+        if (f + 8 > end) return false;
+        offset = le64(&cd[f]);
+      }
+
+      h->second = offset;
+    }
+
+    p += 46 + nameLen + extraLen + commentLen;
+  }
+
+  return true;
+}
+}  // namespace util
+}  // namespace ad
+
 // _____________________________________________________________________________
 ZipCsvParser::ZipCsvParser(zip_file_t* zf) : _zf(zf), _readablePath("?") {
+  init(false);
   readNextLine();
   parseHeader();
 }
 
 // _____________________________________________________________________________
 ZipCsvParser::~ZipCsvParser() {
+  // the reading thread must not outlive the handle
+  stop();
   if (isGood()) zip_fclose(_zf);
 }
 
@@ -36,6 +151,11 @@ ZipCsvParser::ZipCsvParser(zip* za, const std::string& filename)
 // _____________________________________________________________________________
 ZipCsvParser::ZipCsvParser(zip* za, const std::string& filename,
                            const std::string& readablePath)
+    : ZipCsvParser(za, filename, readablePath, false) {}
+
+// _____________________________________________________________________________
+ZipCsvParser::ZipCsvParser(zip* za, const std::string& filename,
+                           const std::string& readablePath, bool threaded)
     : _zf(0), _readablePath(readablePath) {
   // locate file in zip
   auto fi = zip_name_locate(za, filename.c_str(), ZIP_FL_NOCASE | ZIP_FL_NODIR);
@@ -54,53 +174,149 @@ ZipCsvParser::ZipCsvParser(zip* za, const std::string& filename,
   // everything was successful
   _zf = zf;
 
-  readNextLine();
-  parseHeader();
+  init(threaded);
+  try {
+    readNextLine();
+    parseHeader();
+  } catch (...) {
+    // the reading thread must not outlive the handle
+    stop();
+    zip_fclose(_zf);
+    throw;
+  }
 }
 
 // _____________________________________________________________________________
 bool ZipCsvParser::isGood() const { return _zf != 0; }
 
 // _____________________________________________________________________________
-std::pair<size_t, size_t> ZipCsvParser::fetchLine() {
-  if (_zf == 0) return {0, 0};
+std::unordered_map<zip_uint64_t, ZipCsvParser::StoredMember>
+ZipCsvParser::locateStored(zip* za, const std::string& path) {
+  std::unordered_map<zip_uint64_t, StoredMember> ret;
+  std::unordered_map<std::string, uint64_t> headers;
+  std::vector<std::pair<zip_uint64_t, std::string>> stored;
 
-  auto lineEnd =
-      memchr(_buff + (_lastLine + 1), '\n', _bufSize - (_lastLine + 1));
+  zip_int64_t n = zip_get_num_entries(za, 0);
+  for (zip_int64_t i = 0; i < n; i++) {
+    zip_stat_t st;
+    zip_stat_init(&st);
+    if (zip_stat_index(za, i, 0, &st) != 0) continue;
 
-  if (!lineEnd) {
-    // copy end of buffer to tmp buffer
-    memcpy(_tmpBuff, _buff + (_lastLine + 1), _bufSize - (_lastLine + 1));
+    zip_uint64_t req = ZIP_STAT_NAME | ZIP_STAT_SIZE | ZIP_STAT_COMP_METHOD |
+                       ZIP_STAT_ENCRYPTION_METHOD;
+    if ((st.valid & req) != req) continue;
+    if (st.comp_method != ZIP_CM_STORE || st.encryption_method != ZIP_EM_NONE)
+      continue;
 
-    // copy tmp buffer to original buffer
-    memcpy(_buff, _tmpBuff, _bufSize - (_lastLine + 1));
+    ret[i].size = st.size;
+    stored.push_back({i, st.name});
+    headers[st.name] = std::numeric_limits<uint64_t>::max();
+  }
 
-    // only read BUFFER_S - 1 bytes to always have space for the 0 byte
-    auto bytesRead = zip_fread(_zf, _buff + (_bufSize - (_lastLine + 1)),
-                               BUFFER_S - 1 - (_bufSize - (_lastLine + 1)));
+  if (stored.empty()) return ret;
 
-    if (bytesRead < 0) {
-      return {0, 0};
-    }
+  // libzip does not expose the offsets of the data, so they are taken from
+  // the local headers, which are found through the central directory
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return {};
 
-    _bufSize = (_bufSize - (_lastLine + 1)) + bytesRead;
-    _lastLine = -1;
+  if (!findLocalHeaders(fd, &headers)) {
+    close(fd);
+    return {};
+  }
 
-    if (bytesRead == 0) {
-      // arrived at end of file
-      _buff[_bufSize] = 0;
-      _lastLine = _bufSize - 1;
-      return {0, _bufSize};
+  std::vector<unsigned char> h;
+  for (const auto& m : stored) {
+    uint64_t header = headers[m.second];
+    if (header == std::numeric_limits<uint64_t>::max() ||
+        !readAt(fd, header, 30, &h) || le32(&h[0]) != 0x04034b50) {
+      ret.erase(m.first);
+      continue;
     }
+    ret[m.first].offset = header + 30 + le16(&h[26]) + le16(&h[28]);
+  }
+
+  close(fd);
+  return ret;
+}
 
-    return fetchLine();
+// _____________________________________________________________________________
+bool ZipCsvParser::inflateWhole(zip* za, const std::string& filename,
+                                std::unique_ptr<char[]>* data, size_t* size) {
+#ifdef LIBDEFLATE_FOUND
+  auto fi = zip_name_locate(za, filename.c_str(), ZIP_FL_NOCASE | ZIP_FL_NODIR);
+  if (fi < 0) return false;
+
+  zip_stat_t st;
+  zip_stat_init(&st);
+  if (zip_stat_index(za, fi, 0, &st) != 0) return false;
+
+  zip_uint64_t req = ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE | ZIP_STAT_CRC |
+                     ZIP_STAT_COMP_METHOD | ZIP_STAT_ENCRYPTION_METHOD;
+  if ((st.valid & req) != req) return false;
+  if (st.comp_method != ZIP_CM_DEFLATE || st.encryption_method != ZIP_EM_NONE)
+    return false;
+
+  // read the deflate stream as it is stored in the archive
+  auto zf = zip_fopen_index(za, fi, ZIP_FL_COMPRESSED);
+  if (zf == 0) return false;
+
+  std::vector<char> in(st.comp_size);
+  size_t inSize = 0;
+  while (inSize < in.size()) {
+    auto bytesRead = zip_fread(zf, in.data() + inSize, in.size() - inSize);
+    if (bytesRead <= 0) break;
+    inSize += bytesRead;
   }
+  zip_fclose(zf);
 
-  auto ret = std::pair<size_t, size_t>(_lastLine + 1, ((char*)lineEnd - _buff));
-  _buff[ret.second] = 0;
+  if (inSize != in.size()) return false;
 
-  _lastLine = ret.second;
+  libdeflate_decompressor* dec = libdeflate_alloc_decompressor();
+  if (!dec) return false;
 
-  return ret;
+  data->reset(new char[st.size]);
+  *size = st.size;
+  size_t outSize = 0;
+  auto res = libdeflate_deflate_decompress(dec, in.data(), in.size(),
+                                           data->get(), *size, &outSize);
+  libdeflate_free_decompressor(dec);
+
+  // zip_fread checks the CRC, so we do too
+  return res == LIBDEFLATE_SUCCESS && outSize == st.size &&
+         libdeflate_crc32(0, data->get(), *size) == st.crc;
+#else
+  (void)za;
+  (void)filename;
+  (void)data;
+  (void)size;
+  return false;
+#endif
+}
+
+// _____________________________________________________________________________
+zip* ZipCsvParser::openArchive(const std::string& path, const char* data,
+                               size_t size) {
+  if (!data) {
+    int zipErr;
+    return zip_open(path.c_str(), ZIP_RDONLY, &zipErr);
+  }
+
+  // each handle reads through its own source, the data itself is shared
+  zip_source_t* src = zip_source_buffer_create(data, size, 0, 0);
+  if (!src) return 0;
+
+  zip* za = zip_open_from_source(src, ZIP_RDONLY, 0);
+  if (!za) zip_source_free(src);
+  return za;
+}
+
+// _____________________________________________________________________________
+size_t ZipCsvParser::read(char* buf, size_t n) {
+  auto bytesRead = zip_fread(_zf, buf, n);
+  if (bytesRead < 0)
+    throw CsvParserException(zip_file_strerror(_zf), -1, "", -1,
+                             _readablePath);
+  return bytesRead;
 }
 #endif
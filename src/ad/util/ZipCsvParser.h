@@ -13,11 +13,13 @@
 #include <exception>
 #include <iostream>
 #include <istream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "BlockCsvParser.h"
 #include "CsvParser.h"
 
 using std::exception;
@@ -30,7 +32,7 @@ using std::string;
 namespace ad {
 namespace util {
 
-class ZipCsvParser : public CsvParser {
+class ZipCsvParser : public BlockCsvParser {
  public:
   // Initializes the parser by opening the file and reading the table header.
   explicit ZipCsvParser(zip_file_t* zf);
@@ -42,21 +44,48 @@ class ZipCsvParser : public CsvParser {
   ZipCsvParser(zip* za, const std::string& filename,
                const std::string& readableName);
 
+  // Initializes the parser by opening a file in a ZIP, with a readable name.
+  // If threaded is true, the file is inflated on a background thread while
+  // lines are parsed. za must then not be used by anyone else until the
+  // parser is destroyed.
+  ZipCsvParser(zip* za, const std::string& filename,
+               const std::string& readableName, bool threaded);
+
   virtual ~ZipCsvParser();
 
-  virtual std::pair<size_t, size_t> fetchLine();
+  // Where the data of a member stored without compression is in the file.
+  struct StoredMember {
+    size_t offset;
+    size_t size;
+  };
+
+  // Locates the data of the members of za, the ZIP file at path, which are
+  // stored without compression and encryption, by their index in za. The
+  // central directory is read once for all of them.
+  static std::unordered_map<zip_uint64_t, StoredMember> locateStored(
+      zip* za, const std::string& path);
+
+  // Inflates member filename of za in a single call into size bytes at
+  // data, sized from the central directory. Returns false if the member is
+  // not deflated, or if cppgtfs was built without libdeflate.
+  static bool inflateWhole(zip* za, const std::string& filename,
+                           std::unique_ptr<char[]>* data, size_t* size);
+
+  // Opens the ZIP file at path read-only, or the ZIP file of size bytes held
+  // in memory at data, if data is not 0. Returns 0 if it cannot be opened.
+  static zip* openArchive(const std::string& path, const char* data,
+                          size_t size);
+
   virtual bool isGood() const;
-  virtual const string getReadablePath() const { return _readablePath; }
+  virtual const string& getReadablePath() const { return _readablePath; }
+
+ protected:
+  virtual size_t read(char* buf, size_t n);
 
  private:
   // The handle to the file.
   zip_file_t* _zf;
   std::string _readablePath;
-
-  int64_t _lastLine = -1;
-  int64_t _bufSize = 0;
-
-  char _tmpBuff[BUFFER_S] = {0};
 };
 }  // namespace util
 }  // namespace ad
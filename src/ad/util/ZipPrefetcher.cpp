@@ -0,0 +1,219 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifdef LIBZIP_FOUND
+#include <zip.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ZipCsvParser.h"
+#include "ZipPrefetcher.h"
+
+using ad::util::ZipPrefetcher;
+
+// _____________________________________________________________________________
+ZipPrefetcher::ZipPrefetcher(const std::string& path,
+                             const std::vector<std::string>& members,
+                             size_t numThreads, size_t maxBytes)
+    : _path(path),
+      _numThreads(numThreads ? numThreads : 1),
+      _maxBytes(maxBytes) {
+  start(members);
+}
+
+// _____________________________________________________________________________
+ZipPrefetcher::ZipPrefetcher(const char* data, size_t size,
+                             const std::vector<std::string>& members,
+                             size_t numThreads, size_t maxBytes)
+    : _data(data),
+      _size(size),
+      _numThreads(numThreads ? numThreads : 1),
+      _maxBytes(maxBytes) {
+  start(members);
+}
+
+// _____________________________________________________________________________
+void ZipPrefetcher::start(const std::vector<std::string>& members) {
+  _members.resize(members.size());
+  for (size_t i = 0; i < members.size(); i++) {
+    _members[i].name = members[i];
+    _members[i].state = PENDING;
+    _members[i].size = 0;
+    _members[i].reserved = 0;
+  }
+
+  size_t n = std::min(_numThreads, _members.size());
+  for (size_t i = 0; i < n; i++)
+    _threads.push_back(std::thread(&ZipPrefetcher::work, this));
+}
+
+// _____________________________________________________________________________
+ZipPrefetcher::~ZipPrefetcher() {
+  {
+    std::unique_lock<std::mutex> lock(_m);
+    _abort = true;
+  }
+  _cv.notify_all();
+  for (auto& t : _threads) t.join();
+}
+
+// _____________________________________________________________________________
+bool ZipPrefetcher::get(const std::string& member,
+                        std::unique_ptr<char[]>* data, size_t* size) {
+  std::unique_lock<std::mutex> lock(_m);
+
+  size_t i = 0;
+  for (; i < _members.size(); i++) {
+    if (_members[i].name == member) break;
+  }
+
+  if (i == _members.size()) return false;
+
+  if (i + 1 > _requested) {
+    _requested = i + 1;
+    _cv.notify_all();
+  }
+
+  Member& m = _members[i];
+
+  if (m.state == PENDING) {
+    // not started yet (e.g. waiting for memory), the caller reads it
+    // faster on its own
+    m.state = FAILED;
+    _cv.notify_all();
+    return false;
+  }
+
+  _cv.wait(lock, [&] { return m.state >= DONE; });
+
+  if (m.state != DONE) return false;
+
+  // a member can only be handed out once
+  *data = std::move(m.data);
+  *size = m.size;
+  _held -= m.reserved;
+  m.state = FAILED;
+  _cv.notify_all();
+
+  return true;
+}
+
+// _____________________________________________________________________________
+void ZipPrefetcher::work() {
+  zip* za = 0;
+
+  while (true) {
+    size_t i;
+    {
+      std::unique_lock<std::mutex> lock(_m);
+      _cv.wait(lock, [&] {
+        return _abort || _next == _members.size() ||
+               _next < _requested + _numThreads;
+      });
+      if (_abort || _next == _members.size()) break;
+      i = _next++;
+    }
+
+    if (!za) za = ZipCsvParser::openArchive(_path, _data, _size);
+    size_t need = za ? memberSize(za, _members[i].name) : 0;
+
+    {
+      std::unique_lock<std::mutex> lock(_m);
+      Member& m = _members[i];
+
+      if (need == 0 || need > _maxBytes) {
+        // left to the caller, which reads it while parsing
+        if (m.state == PENDING) m.state = FAILED;
+        _cv.notify_all();
+        continue;
+      }
+
+      _cv.wait(lock, [&] {
+        return _abort || m.state != PENDING || _held + need <= _maxBytes;
+      });
+      if (_abort) break;
+      if (m.state != PENDING) continue;
+
+      m.state = RUNNING;
+      m.reserved = need;
+      _held += need;
+    }
+
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    bool ok = read(za, _members[i].name, &data, &size);
+
+    {
+      std::unique_lock<std::mutex> lock(_m);
+      Member& m = _members[i];
+      m.data = std::move(data);
+      m.size = size;
+      m.state = ok ? DONE : FAILED;
+      if (!ok) _held -= m.reserved;
+    }
+    _cv.notify_all();
+  }
+
+  if (za) zip_close(za);
+}
+
+// _____________________________________________________________________________
+size_t ZipPrefetcher::memberSize(zip* za, const std::string& name) {
+  auto fi = zip_name_locate(za, name.c_str(), ZIP_FL_NOCASE | ZIP_FL_NODIR);
+  if (fi < 0) return 0;
+
+  zip_stat_t st;
+  zip_stat_init(&st);
+  if (zip_stat_index(za, fi, 0, &st) != 0 || !(st.valid & ZIP_STAT_SIZE))
+    return 0;
+  return st.size;
+}
+
+// _____________________________________________________________________________
+bool ZipPrefetcher::read(zip* za, const std::string& name,
+                         std::unique_ptr<char[]>* data, size_t* size) {
+  if (ZipCsvParser::inflateWhole(za, name, data, size)) return true;
+
+  // same lookup as in ZipCsvParser
+  auto fi = zip_name_locate(za, name.c_str(), ZIP_FL_NOCASE | ZIP_FL_NODIR);
+  if (fi < 0) return false;
+
+  zip_stat_t st;
+  zip_stat_init(&st);
+  if (zip_stat_index(za, fi, 0, &st) != 0) return false;
+
+  auto zf = zip_fopen_index(za, fi, 0);
+  if (zf == 0) return false;
+
+  // the uncompressed size is only a hint, read until the end of the member.
+  // The buffer is not initialized, it is written by zip_fread() only.
+  size_t cap = (st.valid & ZIP_STAT_SIZE) ? st.size + 1 : (1 << 20);
+  data->reset(new char[cap]);
+  *size = 0;
+
+  while (true) {
+    if (*size == cap) {
+      std::unique_ptr<char[]> grown(new char[cap * 2]);
+      memcpy(grown.get(), data->get(), *size);
+      *data = std::move(grown);
+      cap *= 2;
+    }
+    auto bytesRead = zip_fread(zf, data->get() + *size, cap - *size);
+    if (bytesRead < 0) {
+      zip_fclose(zf);
+      return false;
+    }
+    if (bytesRead == 0) break;
+    *size += bytesRead;
+  }
+
+  zip_fclose(zf);
+  return true;
+}
+#endif
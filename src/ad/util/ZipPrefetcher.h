@@ -0,0 +1,94 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+#ifndef AD_UTIL_ZIPPREFETCHER_H_
+#define AD_UTIL_ZIPPREFETCHER_H_
+
+#ifdef LIBZIP_FOUND
+#include <zip.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Inflates members of a ZIP file in the background, on several threads.
+ * A zip handle must not be used by more than one thread at a time, so each
+ * thread opens the archive on its own.
+ */
+namespace ad {
+namespace util {
+
+class ZipPrefetcher {
+ public:
+  // Starts inflating the members of the ZIP file at path, in the given
+  // order, on up to numThreads threads. At most numThreads members are
+  // inflated ahead of the last member requested with get(), and at most
+  // maxBytes of inflated data are held at once. Members larger than
+  // maxBytes, or of unknown size, are not prefetched.
+  ZipPrefetcher(const std::string& path,
+                const std::vector<std::string>& members, size_t numThreads,
+                size_t maxBytes);
+
+  // Same as above, for a ZIP file held in memory
+  ZipPrefetcher(const char* data, size_t size,
+                const std::vector<std::string>& members, size_t numThreads,
+                size_t maxBytes);
+
+  ~ZipPrefetcher();
+
+  // Moves the contents of member to data and size, waiting until it has
+  // been inflated if that has already started. Returns false if the member
+  // is not prefetched (it then never will be), or could not be read.
+  bool get(const std::string& member, std::unique_ptr<char[]>* data,
+           size_t* size);
+
+  // Reads the complete member name of za into size bytes at data. Returns
+  // false if the member could not be found or read.
+  static bool read(zip* za, const std::string& name,
+                   std::unique_ptr<char[]>* data, size_t* size);
+
+ private:
+  enum STATE : uint8_t { PENDING = 0, RUNNING = 1, DONE = 2, FAILED = 3 };
+
+  struct Member {
+    std::string name;
+    STATE state;
+    std::unique_ptr<char[]> data;
+    size_t size;
+    // the bytes reserved for the member while it is held
+    size_t reserved;
+  };
+
+  std::string _path;
+  const char* _data = 0;
+  size_t _size = 0;
+
+  std::vector<Member> _members;
+  size_t _numThreads;
+  size_t _maxBytes;
+
+  std::mutex _m;
+  std::condition_variable _cv;
+  size_t _next = 0;
+  size_t _requested = 0;
+  size_t _held = 0;
+  bool _abort = false;
+
+  std::vector<std::thread> _threads;
+
+  void start(const std::vector<std::string>& members);
+  void work();
+
+  // the uncompressed size of member name of za, 0 if it is unknown
+  static size_t memberSize(zip* za, const std::string& name);
+};
+}  // namespace util
+}  // namespace ad
+#endif
+
+#endif  // AD_UTIL_ZIPPREFETCHER_H_
@@ -0,0 +1,161 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// Measures the nanoseconds per value CsvParser::atof() takes on the float
+// columns of a file, compared to strtod() and to the fixed-digit atof() it
+// replaced. Also counts the values each of them does not round like strtod().
+//
+// Usage: atofbench <file, e.g. shapes.txt> [column...]
+// Default columns: shape_pt_lat, shape_pt_lon, shape_dist_traveled
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ad/util/CsvParser.h"
+
+using ad::util::CsvParser;
+
+namespace {
+
+// exposes the protected conversion of CsvParser
+class Atof : public CsvParser {
+ public:
+  using CsvParser::atof;
+};
+
+// The atof() CsvParser used before, reading at most mn decimal places and
+// accumulating them with repeated multiplications. Not inlined, like
+// CsvParser::atof(), which is defined in another unit.
+__attribute__((noinline)) double oldAtof(const char* p, uint8_t mn,
+                                         bool* fail) {
+  static const int pow10[10] = {1,      10,      100,      1000,
+                                10000,  100000,  1000000,  10000000,
+                                100000000, 1000000000};
+  double ret = 0.0;
+  bool neg = false;
+  if (*p == '-') {
+    neg = true;
+    p++;
+  }
+
+  while (*p >= '0' && *p <= '9') {
+    ret = ret * 10.0 + (*p - '0');
+    p++;
+  }
+
+  if (*p == '.') {
+    p++;
+    double f = 0;
+    uint8_t n = 0;
+
+    for (; n < mn && *p >= '0' && *p <= '9'; n++, p++) {
+      f = f * 10.0 + (*p - '0');
+    }
+
+    if (n < 10)
+      ret += f / pow10[n];
+    else
+      ret += f / std::pow(10, n);
+  } else if (*p != 0 && *p != ' ') {
+    *fail = true;
+    return 0;
+  }
+
+  if (neg) return -ret;
+  return ret;
+}
+
+// ____________________________________________________________________________
+template <typename F>
+double measure(const std::vector<const char*>& vals, size_t reps, F f,
+               double* sum) {
+  auto t = std::chrono::steady_clock::now();
+  double s = 0;
+  for (size_t r = 0; r < reps; r++) {
+    for (const char* v : vals) s += f(v);
+  }
+  double ns = std::chrono::duration<double, std::nano>(
+                  std::chrono::steady_clock::now() - t)
+                  .count();
+  *sum += s;
+  return ns / (reps * vals.size());
+}
+}  // namespace
+
+// ____________________________________________________________________________
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file> [column...]" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> cols;
+  for (int i = 2; i < argc; i++) cols.push_back(argv[i]);
+  if (cols.empty()) {
+    cols = {"shape_pt_lat", "shape_pt_lon", "shape_dist_traveled"};
+  }
+
+  std::vector<std::string> strs;
+  CsvParser p(argv[1]);
+  std::vector<size_t> idx;
+  for (const auto& c : cols) {
+    if (p.hasItem(c)) idx.push_back(p.getFieldIndex(c));
+  }
+  while (p.readNextLine()) {
+    for (size_t i : idx) {
+      if (i < p.getNumColumns() && !p.fieldIsEmpty(i)) {
+        strs.push_back(p.getTString(i));
+      }
+    }
+  }
+
+  if (strs.empty()) {
+    std::cerr << "No values found in " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::vector<const char*> vals;
+  for (const auto& s : strs) vals.push_back(s.c_str());
+
+  // at least 20 million conversions per function
+  size_t reps = 20000000 / vals.size() + 1;
+
+  size_t wrongNew = 0, wrongOld = 0;
+  for (const char* v : vals) {
+    bool fail = false;
+    double ref = strtod(v, 0);
+    if (Atof::atof(v, &fail) != ref) wrongNew++;
+    if (oldAtof(v, 38, &fail) != ref) wrongOld++;
+  }
+
+  // best of 5 runs each
+  double sum = 0, nsNew = 0, nsStrtod = 0, nsOld = 0;
+  for (int i = 0; i < 5; i++) {
+    double ns = measure(vals, reps, [](const char* v) {
+      bool fail = false;
+      return Atof::atof(v, &fail);
+    }, &sum);
+    if (i == 0 || ns < nsNew) nsNew = ns;
+    ns = measure(vals, reps, [](const char* v) { return strtod(v, 0); }, &sum);
+    if (i == 0 || ns < nsStrtod) nsStrtod = ns;
+    ns = measure(vals, reps, [](const char* v) {
+      bool fail = false;
+      return oldAtof(v, 38, &fail);
+    }, &sum);
+    if (i == 0 || ns < nsOld) nsOld = ns;
+  }
+
+  std::cout << vals.size() << " values, " << reps << " repetitions (checksum "
+            << sum << ")" << std::endl;
+  std::cout << "CsvParser::atof: " << nsNew << " ns/value, " << wrongNew
+            << " values rounded differently from strtod" << std::endl;
+  std::cout << "strtod:          " << nsStrtod << " ns/value" << std::endl;
+  std::cout << "previous atof:   " << nsOld << " ns/value, " << wrongOld
+            << " values rounded differently from strtod" << std::endl;
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// Measures the nanoseconds per lookup of ids in the feed (hits) and of ids
+// not in the feed (misses) for Container, SlabContainer and ContContainer,
+// the latter two with and without a FrozenIndex, and how long finalize()
+// takes. The
+// ids look like the ids of real feeds, and are looked up in random order.
+//
+// Usage: containerbench [number of ids]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "ad/cppgtfs/gtfs/Container.h"
+#include "ad/cppgtfs/gtfs/ContContainer.h"
+#include "ad/cppgtfs/gtfs/Level.h"
+#include "ad/cppgtfs/gtfs/SlabContainer.h"
+
+using ad::cppgtfs::gtfs::ContContainer;
+using ad::cppgtfs::gtfs::Container;
+using ad::cppgtfs::gtfs::Level;
+using ad::cppgtfs::gtfs::SlabContainer;
+
+namespace {
+
+// ____________________________________________________________________________
+double msSince(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t)
+      .count();
+}
+
+// ____________________________________________________________________________
+template <typename C>
+size_t lookup(C* c, const std::vector<std::string>& ids, double* ns) {
+  // best of 3 runs
+  size_t found = 0;
+  for (int i = 0; i < 3; i++) {
+    found = 0;
+    auto t = std::chrono::steady_clock::now();
+    for (const auto& id : ids) found += c->get(id) != 0;
+    double runNs = msSince(t) * 1e6 / ids.size();
+    if (i == 0 || runNs < *ns) *ns = runNs;
+  }
+  return found;
+}
+
+// ____________________________________________________________________________
+template <typename C>
+void bench(const char* name, bool frozen, const std::vector<std::string>& ids,
+           const std::vector<std::string>& hits,
+           const std::vector<std::string>& misses) {
+  C c;
+  c.setFrozenIndex(frozen);
+  for (const auto& id : ids) c.add(Level(id, 0, ""));
+
+  auto t = std::chrono::steady_clock::now();
+  c.finalize();
+  double finalizeMs = msSince(t);
+
+  double hitNs = 0, missNs = 0;
+  size_t found = lookup(&c, hits, &hitNs);
+  found += lookup(&c, misses, &missNs);
+
+  if (found != hits.size()) {
+    std::cerr << name << ": found " << found << " of " << hits.size()
+              << " ids" << std::endl;
+    exit(1);
+  }
+
+  std::cout << std::setw(16) << std::left << name << std::setw(8)
+            << (frozen ? "frozen" : "-") << std::right << std::setw(14)
+            << finalizeMs << std::setw(10) << hitNs << std::setw(10) << missNs
+            << std::endl;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? atol(argv[1]) : 1000000;
+
+  std::mt19937 rng(1);
+  std::vector<std::string> ids, misses;
+  for (size_t i = 0; i < n; i++) {
+    ids.push_back("de:08311:" + std::to_string(rng() % 100000) + ":" +
+                  std::to_string(i) + ":trip");
+    misses.push_back("de:08311:" + std::to_string(rng() % 100000) + ":" +
+                     std::to_string(i) + ":stop");
+  }
+
+  std::vector<std::string> hits = ids;
+  std::shuffle(hits.begin(), hits.end(), rng);
+
+  std::cout << n << " ids" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(16) << std::left << "container" << std::setw(8)
+            << "index" << std::right << std::setw(14) << "finalize ms"
+            << std::setw(10) << "hit ns" << std::setw(10) << "miss ns"
+            << std::endl;
+
+  // Container ignores setFrozenIndex()
+  bench<Container<Level>>("Container", false, ids, hits, misses);
+  for (bool frozen : {false, true}) {
+    bench<SlabContainer<Level>>("SlabContainer", frozen, ids, hits, misses);
+    bench<ContContainer<Level>>("ContContainer", frozen, ids, hits, misses);
+  }
+  return 0;
+}
@@ -0,0 +1,204 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// Measures the rows per second the CSV tokenizer reads from a file, compared
+// to the strchr-based tokenizer it replaced. The file is read once before
+// the runs, so both read from memory.
+//
+// Usage: csvbench <file, e.g. stop_times.txt> [runs]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "ad/util/CsvParser.h"
+
+using ad::util::CsvParser;
+
+namespace {
+
+// The tokenizer CsvParser::readNextLine() used before the line was
+// classified in blocks: each field is searched for with strchr(), fields
+// with escaped quotes are copied to strings.
+class StrchrTokenizer {
+ public:
+  StrchrTokenizer(const std::vector<char>& data) : _data(data), _pos(0) {}
+
+  bool readNextLine() {
+    if (_pos >= _data.size()) return false;
+    const char* start = _data.data() + _pos;
+    const char* nl = static_cast<const char*>(
+        memchr(start, '\n', _data.size() - _pos));
+    size_t n = nl ? nl - start : _data.size() - _pos;
+    _pos += n + 1;
+    if (n >= sizeof(_buff)) n = sizeof(_buff) - 1;
+    memcpy(_buff, start, n);
+    _buff[n] = 0;
+
+    size_t lineLen = n;
+    while (lineLen && (_buff[lineLen - 1] == '\r' ||
+                       _buff[lineLen - 1] == '\n')) {
+      _buff[--lineLen] = 0;
+    }
+    if (lineLen == 0) return readNextLine();
+
+    size_t pos = 0;
+    size_t lastPos = pos;
+    bool firstChar = false;
+    bool esc = false;
+    int escQuotesFound = 0;
+    _items.clear();
+    _modItems.clear();
+
+    while (pos < lineLen) {
+      if (!firstChar && std::isspace(_buff[pos])) {
+        lastPos = ++pos;
+        continue;
+      }
+
+      if (_buff[pos] == '"' && !esc) {
+        esc = true;
+        lastPos = ++pos;
+        continue;
+      }
+
+      firstChar = true;
+
+      if (!esc) {
+        const char* c = strchr(_buff + pos, ',');
+        pos = c ? c - _buff : lineLen - 1;
+      } else {
+        const char* c = strchr(_buff + pos, '"');
+        pos = c ? c - _buff : lineLen - 1;
+
+        if (pos < lineLen - 1 && _buff[pos + 1] == '"') {
+          pos += 2;
+          escQuotesFound++;
+          continue;
+        } else {
+          _buff[pos] = 0;
+          esc = false;
+          firstChar = false;
+          c = strchr(_buff + pos + 1, ',');
+          pos = c ? c - _buff : lineLen - 1;
+        }
+      }
+
+      if (_buff[pos] == ',') {
+        _buff[pos] = 0;
+        firstChar = false;
+      }
+
+      if (!escQuotesFound) {
+        _items.push_back(rightTrim(_buff + lastPos));
+      } else {
+        size_t p = -1;
+        _modItems.push_back(_buff + lastPos);
+        while (escQuotesFound) {
+          p = _modItems.back().find("\"\"", p + 1);
+          if (p != std::string::npos) _modItems.back().replace(p, 2, "\"");
+          escQuotesFound--;
+        }
+        _items.push_back(rightTrim(_modItems.back().c_str()));
+      }
+
+      lastPos = ++pos;
+    }
+    return true;
+  }
+
+  size_t getNumColumns() const { return _items.size(); }
+  ad::util::CsvField getField(size_t i) const {
+    return {_items[i], std::strlen(_items[i])};
+  }
+
+ private:
+  const std::vector<char>& _data;
+  size_t _pos;
+  char _buff[ad::util::BUFFER_S];
+  std::vector<const char*> _items;
+  std::vector<std::string> _modItems;
+
+  static const char* rightTrim(const char* t) {
+    char* s = const_cast<char*>(t);
+    char* end = s + std::strlen(s) - 1;
+    while (end >= s && std::isspace(*end)) *end-- = 0;
+    return s;
+  }
+};
+
+// ____________________________________________________________________________
+template <typename P>
+size_t readAll(P* p, size_t* rows) {
+  size_t sum = 0;
+  *rows = 0;
+  while (p->readNextLine()) {
+    (*rows)++;
+    sum += p->getNumColumns();
+    if (p->getNumColumns() && p->getField(0).len)
+      sum += p->getField(0).begin[0];
+  }
+  return sum;
+}
+
+// ____________________________________________________________________________
+void report(const char* name, size_t rows, size_t bytes, double ms) {
+  std::cout << name << ": " << rows << " rows in " << ms << " ms, "
+            << static_cast<size_t>(rows / (ms / 1000)) << " rows/s, "
+            << static_cast<size_t>(bytes / (ms / 1000) / (1 << 20))
+            << " MB/s" << std::endl;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file> [runs]" << std::endl;
+    return 1;
+  }
+  std::string path = argv[1];
+  int runs = argc > 2 ? atoi(argv[2]) : 5;
+
+  std::ifstream in(path, std::ios::binary);
+  std::vector<char> data((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+  if (!in.eof() && !in.good()) {
+    std::cerr << "Could not read " << path << std::endl;
+    return 1;
+  }
+
+  double bestNew = 0, bestOld = 0;
+  size_t rowsNew = 0, rowsOld = 0, check = 0;
+
+  for (int i = 0; i < runs; i++) {
+    // the file is in the page cache after reading it above
+    auto t = std::chrono::steady_clock::now();
+    CsvParser p(path);
+    check += readAll(&p, &rowsNew);
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t)
+                    .count();
+    if (i == 0 || ms < bestNew) bestNew = ms;
+
+    t = std::chrono::steady_clock::now();
+    StrchrTokenizer o(data);
+    o.readNextLine();  // header
+    check += readAll(&o, &rowsOld);
+    ms = std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t)
+             .count();
+    if (i == 0 || ms < bestOld) bestOld = ms;
+  }
+
+  std::cout << "best of " << runs << " runs (checksum " << check << ")"
+            << std::endl;
+  report("CsvParser", rowsNew, data.size(), bestNew);
+  report("strchr tokenizer", rowsOld, data.size(), bestOld);
+  std::cout << "speedup: " << bestOld / bestNew << "x" << std::endl;
+  return 0;
+}
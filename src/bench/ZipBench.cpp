@@ -0,0 +1,69 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: cppgtfs contributors <https://github.com/ad-freiburg/cppgtfs>
+
+// Measures how long parse() takes to read a ZIP feed with a given number of
+// threads, and optionally with its members prefetched, and the peak memory
+// it takes. Run it once per configuration, the peak memory is the one of
+// the process.
+//
+// Usage: zipbench <feed.zip> [threads] [prefetch MB]
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "ad/cppgtfs/Parser.h"
+#include "ad/cppgtfs/gtfs/Feed.h"
+
+using ad::cppgtfs::Parser;
+using ad::cppgtfs::ParserTableStats;
+
+// ____________________________________________________________________________
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <feed.zip> [threads] [prefetch MB]"
+              << std::endl;
+    return 1;
+  }
+
+  size_t threads = argc > 2 ? atol(argv[2]) : 0;
+  size_t prefetchMb = argc > 3 ? atol(argv[3]) : 0;
+
+  Parser p(argv[1]);
+  p.setNumThreads(threads);
+  p.setZipPrefetch(prefetchMb << 20);
+
+  ad::cppgtfs::gtfs::Feed feed;
+  try {
+    p.parse(&feed);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  const auto& stats = p.getStats();
+
+  std::cout << std::fixed << std::setprecision(0);
+  std::cout << std::setw(20) << std::left << "table" << std::right
+            << std::setw(12) << "MB (zip)" << std::setw(10) << "MB"
+            << std::setw(10) << "open ms" << std::setw(10) << "read ms"
+            << std::setw(10) << "wall ms" << std::setw(10) << "cpu ms"
+            << std::endl;
+  for (const ParserTableStats& t : stats.tables) {
+    if (t.bytes == 0) continue;
+    std::cout << std::setw(20) << std::left << t.file << std::right
+              << std::setw(12) << t.compressedBytes / (1 << 20)
+              << std::setw(10) << t.bytes / (1 << 20) << std::setw(10)
+              << t.openMs << std::setw(10) << t.readMs << std::setw(10)
+              << t.wallMs << std::setw(10) << t.cpuMs << std::endl;
+  }
+
+  if (!threads) threads = std::thread::hardware_concurrency();
+  std::cout << "threads: " << threads << ", prefetch: " << prefetchMb << " MB"
+            << std::endl;
+  std::cout << "wall: " << stats.wallMs << " ms, cpu: " << stats.cpuMs
+            << " ms, peak rss: " << (stats.peakRss >> 20) << " MB"
+            << std::endl;
+  return 0;
+}